@@ -0,0 +1,58 @@
+#pragma once
+
+// Host stand-in for the CommonLibSSE forced include
+// Provides the SKSE integer types, the member function helpers used by hooks, and the few Windows names the plugin sees through it
+
+#include <cstdint>  // uint8_t, int8_t, uintptr_t
+#include <cstdio>  // FILE
+#include <cstring>  // memcpy
+#include <ctime>  // time_t, tm
+#include <typeinfo>  // typeid
+
+
+using UInt8 = std::uint8_t;
+using UInt16 = std::uint16_t;
+using UInt32 = std::uint32_t;
+using UInt64 = std::uint64_t;
+using SInt8 = std::int8_t;
+using SInt16 = std::int16_t;
+using SInt32 = std::int32_t;
+using SInt64 = std::int64_t;
+
+
+template <class T>
+struct function_type;
+
+
+template <class R, class C, class... Args>
+struct function_type<R (C::*)(Args...)>
+{
+	using type = R(C*, Args...);
+};
+
+
+template <class T>
+using function_type_t = typename function_type<T>::type;
+
+
+// Address of a non-virtual member function, read from the first word of the pointer as the Itanium ABI lays it out
+template <class T>
+std::uintptr_t GetFnAddr(T a_fn)
+{
+	std::uintptr_t addr;
+	std::memcpy(&addr, &a_fn, sizeof(addr));
+	return addr;
+}
+
+
+struct KNOWNFOLDERID
+{
+	int id;
+};
+
+
+inline constexpr KNOWNFOLDERID FOLDERID_Documents{ 0 };
+
+
+int _wfopen_s(std::FILE** a_file, const wchar_t* a_path, const wchar_t* a_mode);
+int localtime_s(std::tm* a_tm, const std::time_t* a_time);
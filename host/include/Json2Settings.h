@@ -0,0 +1,56 @@
+#pragma once
+
+// Host stand-in for Json2Settings
+// No file is read, settings keep their defaults unless a driver assigns them
+
+#include <string>  // string
+
+
+namespace Json2Settings
+{
+	template <class T>
+	class aSetting
+	{
+	public:
+		aSetting(const char* a_key, T a_value) :
+			_key(a_key),
+			_value(a_value)
+		{}
+
+
+		operator T() const
+		{
+			return _value;
+		}
+
+
+		aSetting& operator=(T a_value)
+		{
+			_value = a_value;
+			return *this;
+		}
+
+
+		const std::string& key() const
+		{
+			return _key;
+		}
+
+	private:
+		std::string _key;
+		T _value;
+	};
+
+
+	class Settings
+	{
+	public:
+		using bSetting = aSetting<bool>;
+		using iSetting = aSetting<int>;
+		using fSetting = aSetting<float>;
+
+
+		static bool loadSettings(const char* a_fileName, bool a_dumpParse = false);
+		static void dump();
+	};
+}
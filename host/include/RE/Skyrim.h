@@ -0,0 +1,731 @@
+#pragma once
+
+// Host stand-in for the CommonLibSSE engine types the plugin uses
+// Only the members the plugin touches are declared, with the same names and signatures, and the in-memory simulator implements them
+// Lists keep the engine's shape (singly linked entry and extra lists) so walks cost roughly what they cost in game
+
+#include <algorithm>  // find
+#include <bitset>  // bitset
+#include <cstddef>  // size_t
+#include <forward_list>  // forward_list
+#include <memory>  // unique_ptr
+#include <string_view>  // string_view
+#include <tuple>  // tuple, get
+#include <vector>  // vector
+
+
+namespace RE
+{
+	using FormID = UInt32;
+
+
+	enum class FormType : UInt8
+	{
+		None = 0,
+		Keyword = 4,
+		Race = 10,
+		Enchantment = 21,
+		Armor = 26,
+		Misc = 32,
+		Weapon = 41,
+		Ammo = 42,
+		ActorCharacter = 62
+	};
+
+
+	enum class BSEventNotifyControl
+	{
+		kContinue,
+		kStop
+	};
+
+
+	template <class T>
+	class BSSimpleList
+	{
+	public:
+		using iterator = typename std::forward_list<T>::iterator;
+
+
+		iterator begin() { return _list.begin(); }
+		iterator end() { return _list.end(); }
+		bool empty() const { return _list.empty(); }
+		T& front() { return _list.front(); }
+		void push_front(const T& a_value) { _list.push_front(a_value); }
+		void remove(const T& a_value) { _list.remove(a_value); }
+
+	private:
+		std::forward_list<T> _list;
+	};
+
+
+	class BSFixedString
+	{
+	public:
+		BSFixedString();
+		BSFixedString(const char* a_string);
+		BSFixedString(std::string_view a_string);
+
+		const char* data() const { return _data; }
+		const char* c_str() const { return _data; }
+		std::size_t size() const { return _size; }
+		std::size_t length() const { return _size; }
+		bool empty() const { return _size == 0; }
+		operator std::string_view() const { return { _data, _size }; }
+		bool operator==(const BSFixedString& a_rhs) const { return _data == a_rhs._data; }
+		bool operator!=(const BSFixedString& a_rhs) const { return _data != a_rhs._data; }
+
+	private:
+		const char* _data;
+		std::size_t _size;
+	};
+
+
+	enum class ExtraDataType : UInt8
+	{
+		kWorn = 0x16,
+		kWornLeft = 0x17,
+		kHealth = 0x25,
+		kEnchantment = 0x9B
+	};
+
+
+	class BSExtraData
+	{
+	public:
+		virtual ~BSExtraData() = default;
+		virtual ExtraDataType GetType() const = 0;
+	};
+
+
+	template <ExtraDataType TYPE>
+	class BSExtraDataT : public BSExtraData
+	{
+	public:
+		static constexpr auto EXTRADATATYPE = TYPE;
+
+
+		virtual ExtraDataType GetType() const override { return EXTRADATATYPE; }
+	};
+
+
+	class EnchantmentItem;
+
+
+	class ExtraWorn : public BSExtraDataT<ExtraDataType::kWorn> {};
+	class ExtraWornLeft : public BSExtraDataT<ExtraDataType::kWornLeft> {};
+
+
+	class ExtraHealth : public BSExtraDataT<ExtraDataType::kHealth>
+	{
+	public:
+		explicit ExtraHealth(float a_health = 1.0F) : health(a_health) {}
+
+		float health;
+	};
+
+
+	class ExtraEnchantment : public BSExtraDataT<ExtraDataType::kEnchantment>
+	{
+	public:
+		explicit ExtraEnchantment(EnchantmentItem* a_enchantment = 0) : enchantment(a_enchantment), charge(0), removeOnUnequip(false) {}
+
+		EnchantmentItem* enchantment;
+		UInt16 charge;
+		bool removeOnUnequip;
+	};
+
+
+	class ExtraDataList
+	{
+	public:
+		ExtraDataList() = default;
+		ExtraDataList(const ExtraDataList&) = delete;
+		ExtraDataList& operator=(const ExtraDataList&) = delete;
+
+		bool HasType(ExtraDataType a_type) const { return _presence.test(static_cast<std::size_t>(a_type)); }
+		BSExtraData* GetByType(ExtraDataType a_type) const;
+		template <class T> T* GetByType() const { return static_cast<T*>(GetByType(T::EXTRADATATYPE)); }
+		void Add(BSExtraData* a_data);
+		bool Remove(ExtraDataType a_type);
+		bool empty() const { return _data.empty(); }
+
+	private:
+		std::vector<std::unique_ptr<BSExtraData>> _data;
+		std::bitset<256> _presence;
+	};
+
+
+	class TESForm
+	{
+	public:
+		static constexpr auto FORMTYPE = FormType::None;
+
+
+		TESForm(FormType a_formType, FormID a_formID) : formID(a_formID), formType(a_formType) {}
+		virtual ~TESForm() = default;
+
+		static TESForm* LookupByID(FormID a_formID);
+
+		template <class T>
+		static T* LookupByID(FormID a_formID)
+		{
+			auto form = LookupByID(a_formID);
+			return form && form->Is(T::FORMTYPE) ? static_cast<T*>(form) : 0;
+		}
+
+		bool Is(FormType a_formType) const { return formType == a_formType; }
+		bool IsAmmo() const { return formType == FormType::Ammo; }
+		bool IsArmor() const { return formType == FormType::Armor; }
+		bool IsWeapon() const { return formType == FormType::Weapon; }
+		bool IsGold() const { return formID == 0x0000000F; }
+		FormType GetFormType() const { return formType; }
+
+
+		FormID formID;
+		FormType formType;
+	};
+
+
+	class TESBoundObject : public TESForm
+	{
+	public:
+		using TESForm::TESForm;
+	};
+
+
+	class BGSKeyword : public TESForm
+	{
+	public:
+		static constexpr auto FORMTYPE = FormType::Keyword;
+
+
+		explicit BGSKeyword(FormID a_formID) : TESForm(FORMTYPE, a_formID) {}
+	};
+
+
+	class TESRace : public TESForm
+	{
+	public:
+		static constexpr auto FORMTYPE = FormType::Race;
+
+
+		explicit TESRace(FormID a_formID) : TESForm(FORMTYPE, a_formID) {}
+	};
+
+
+	class EnchantmentItem : public TESForm
+	{
+	public:
+		static constexpr auto FORMTYPE = FormType::Enchantment;
+
+
+		explicit EnchantmentItem(FormID a_formID) : TESForm(FORMTYPE, a_formID) {}
+	};
+
+
+	class BGSEquipSlot : public TESForm
+	{
+	public:
+		explicit BGSEquipSlot(FormID a_formID) : TESForm(FormType::None, a_formID) {}
+	};
+
+
+	struct BIPED_MODEL
+	{
+		enum class BipedObjectSlot : UInt32
+		{
+			kNone = 0,
+			kHead = 1 << 0,
+			kHair = 1 << 1,
+			kBody = 1 << 2,
+			kHands = 1 << 3,
+			kForearms = 1 << 4,
+			kAmulet = 1 << 5,
+			kRing = 1 << 6,
+			kFeet = 1 << 7,
+			kCalves = 1 << 8,
+			kShield = 1 << 9,
+			kTail = 1 << 10,
+			kLongHair = 1 << 11,
+			kCirclet = 1 << 12,
+			kEars = 1 << 13
+		};
+	};
+
+
+	class TESObjectARMO : public TESBoundObject
+	{
+	public:
+		static constexpr auto FORMTYPE = FormType::Armor;
+
+
+		enum class ArmorType : UInt32
+		{
+			kLightArmor,
+			kHeavyArmor,
+			kClothing
+		};
+
+
+		TESObjectARMO(FormID a_formID, BIPED_MODEL::BipedObjectSlot a_slots, ArmorType a_armorType) :
+			TESBoundObject(FORMTYPE, a_formID),
+			equipSlot(0),
+			slots(a_slots),
+			armorType(a_armorType)
+		{}
+
+		bool HasPartOf(BIPED_MODEL::BipedObjectSlot a_slot) const { return (static_cast<UInt32>(slots) & static_cast<UInt32>(a_slot)) != 0; }
+		bool IsLightArmor() const { return armorType == ArmorType::kLightArmor; }
+		bool IsHeavyArmor() const { return armorType == ArmorType::kHeavyArmor; }
+		bool IsShield() const { return HasPartOf(BIPED_MODEL::BipedObjectSlot::kShield); }
+		BIPED_MODEL::BipedObjectSlot GetSlotMask() const { return slots; }
+
+
+		BGSEquipSlot* equipSlot;
+		BIPED_MODEL::BipedObjectSlot slots;
+		ArmorType armorType;
+	};
+
+
+	class TESObjectWEAP : public TESBoundObject
+	{
+	public:
+		static constexpr auto FORMTYPE = FormType::Weapon;
+
+
+		enum class WeaponType : UInt8
+		{
+			kOneHandSword,
+			kTwoHandSword,
+			kBow,
+			kStaff,
+			kCrossbow
+		};
+
+
+		TESObjectWEAP(FormID a_formID, WeaponType a_weaponType, bool a_bound) :
+			TESBoundObject(FORMTYPE, a_formID),
+			equipSlot(0),
+			weaponType(a_weaponType),
+			bound(a_bound)
+		{}
+
+		bool IsBow() const { return weaponType == WeaponType::kBow; }
+		bool IsCrossbow() const { return weaponType == WeaponType::kCrossbow; }
+		bool IsBound() const { return bound; }
+
+
+		BGSEquipSlot* equipSlot;
+		WeaponType weaponType;
+		bool bound;
+	};
+
+
+	class TESAmmo : public TESBoundObject
+	{
+	public:
+		static constexpr auto FORMTYPE = FormType::Ammo;
+
+
+		explicit TESAmmo(FormID a_formID) : TESBoundObject(FORMTYPE, a_formID) {}
+
+		bool HasKeyword(BGSKeyword* a_keyword) const { return a_keyword && std::find(keywords.begin(), keywords.end(), a_keyword) != keywords.end(); }
+
+
+		std::vector<BGSKeyword*> keywords;
+	};
+
+
+	class TESObjectMISC : public TESBoundObject
+	{
+	public:
+		static constexpr auto FORMTYPE = FormType::Misc;
+
+
+		explicit TESObjectMISC(FormID a_formID) : TESBoundObject(FORMTYPE, a_formID) {}
+	};
+
+
+	class InventoryEntryData
+	{
+	public:
+		InventoryEntryData(TESBoundObject* a_object, SInt32 a_countDelta) : object(a_object), extraLists(0), countDelta(a_countDelta) {}
+
+
+		TESBoundObject* object;
+		BSSimpleList<ExtraDataList*>* extraLists;
+		SInt32 countDelta;
+	};
+
+
+	class InventoryChanges
+	{
+	public:
+		InventoryChanges() : entryList(new BSSimpleList<InventoryEntryData*>()) {}
+
+
+		BSSimpleList<InventoryEntryData*>* entryList;
+	};
+
+
+	struct ContainerObject
+	{
+		SInt32 count;
+		TESBoundObject* obj;
+	};
+
+
+	class TESContainer
+	{
+	public:
+		template <class Fn>
+		void ForEachContainerObject(Fn a_fn)
+		{
+			for (auto& entry : containerObjects) {
+				if (!a_fn(&entry)) {
+					break;
+				}
+			}
+		}
+
+
+		std::vector<ContainerObject> containerObjects;
+	};
+
+
+	template <class T>
+	class NiPointer
+	{
+	public:
+		NiPointer(T* a_ptr = 0) : _ptr(a_ptr) {}
+
+		T* get() const { return _ptr; }
+		T* operator->() const { return _ptr; }
+		explicit operator bool() const { return _ptr != 0; }
+
+	private:
+		T* _ptr;
+	};
+
+
+	template <class E> class BSTEventSource;
+
+
+	template <class E>
+	class BSTEventSink
+	{
+	public:
+		virtual ~BSTEventSink() = default;
+		virtual BSEventNotifyControl ProcessEvent(const E* a_event, BSTEventSource<E>* a_eventSource) = 0;
+	};
+
+
+	template <class E>
+	class BSTEventSource
+	{
+	public:
+		void AddEventSink(BSTEventSink<E>* a_sink)
+		{
+			if (std::find(sinks.begin(), sinks.end(), a_sink) == sinks.end()) {
+				sinks.push_back(a_sink);
+			}
+		}
+
+
+		void RemoveEventSink(BSTEventSink<E>* a_sink)
+		{
+			auto it = std::find(sinks.begin(), sinks.end(), a_sink);
+			if (it != sinks.end()) {
+				sinks.erase(it);
+			}
+		}
+
+
+		void SendEvent(const E* a_event)
+		{
+			auto copy = sinks;
+			for (auto& sink : copy) {
+				if (sink->ProcessEvent(a_event, this) == BSEventNotifyControl::kStop) {
+					break;
+				}
+			}
+		}
+
+
+		std::vector<BSTEventSink<E>*> sinks;
+	};
+
+
+	class TESObjectREFR;
+
+
+	struct TESEquipEvent
+	{
+		NiPointer<TESObjectREFR> hActor;
+		FormID baseObject;
+		FormID originalRefr;
+		UInt16 uniqueID;
+		bool equipped;
+	};
+
+
+	struct TESObjectLoadedEvent
+	{
+		FormID formID;
+		bool loaded;
+	};
+
+
+	struct TESContainerChangedEvent
+	{
+		FormID oldContainer;
+		FormID newContainer;
+		FormID baseObj;
+		SInt32 itemCount;
+		FormID referenceID;
+		UInt16 uniqueID;
+	};
+
+
+	struct TESSwitchRaceCompleteEvent
+	{
+		NiPointer<TESObjectREFR> subject;
+	};
+
+
+	struct BSAnimationGraphEvent
+	{
+		BSFixedString tag;
+		const TESObjectREFR* holder;
+		BSFixedString payload;
+	};
+
+
+	struct MenuOpenCloseEvent
+	{
+		BSFixedString menuName;
+		bool opening;
+	};
+
+
+	class BShkbAnimationGraph
+	{
+	public:
+		template <class E>
+		BSTEventSource<E>* GetEventSource() { return &_animationEventSource; }
+
+	private:
+		BSTEventSource<BSAnimationGraphEvent> _animationEventSource;
+	};
+
+
+	class BSAnimationGraphManager
+	{
+	public:
+		std::vector<BShkbAnimationGraph*> graphs;
+	};
+
+
+	using BSAnimationGraphManagerPtr = NiPointer<BSAnimationGraphManager>;
+
+
+	class TESObjectREFR : public TESForm
+	{
+	public:
+		using TESForm::TESForm;
+
+		bool IsPlayerRef() const;
+		InventoryChanges* GetInventoryChanges() { return _changes; }
+		TESContainer* GetContainer() { return &_container; }
+
+	protected:
+		InventoryChanges* _changes = 0;
+		TESContainer _container;
+
+	};
+
+
+	class AIProcess
+	{
+	public:
+		TESForm* GetEquippedLeftHand() { return leftHand; }
+		TESForm* GetEquippedRightHand() { return rightHand; }
+
+
+		TESForm* leftHand = 0;
+		TESForm* rightHand = 0;
+	};
+
+
+	class Actor : public TESObjectREFR
+	{
+	public:
+		using TESObjectREFR::TESObjectREFR;
+
+		TESRace* GetRace() { return race; }
+		bool IsWeaponDrawn() { return weaponDrawn; }
+		bool GetAnimationGraphManager(BSAnimationGraphManagerPtr& a_out) { a_out = &_graphManager; return true; }
+
+
+		AIProcess* currentProcess = &_process;
+		TESRace* race = 0;
+		bool weaponDrawn = false;
+
+	protected:
+		AIProcess _process;
+		BSAnimationGraphManager _graphManager;
+	};
+
+
+	class PlayerCharacter : public Actor
+	{
+	public:
+		static PlayerCharacter* GetSingleton();
+
+		// Reached through the vtable slot at Offset::PlayerCharacter::Vtbl + 0xB2 * 8, so hooks written there run
+		void OnItemEquipped(bool a_playAnim);
+
+		// Reached through the vtable slot at Offset::PlayerCharacter::Vtbl + 0xAD * 8, once per simulated frame
+		void Update(float a_delta);
+
+	protected:
+		PlayerCharacter();
+
+	};
+
+
+	class ActorEquipManager
+	{
+	public:
+		static ActorEquipManager* GetSingleton();
+
+		void EquipItem(Actor* a_actor, TESBoundObject* a_object, ExtraDataList* a_extraData = 0, UInt32 a_count = 1, BGSEquipSlot* a_slot = 0, bool a_queueEquip = true, bool a_forceEquip = false, bool a_playSounds = true, bool a_applyNow = false);
+		void UnequipItem(Actor* a_actor, TESBoundObject* a_object, ExtraDataList* a_extraData = 0, UInt32 a_count = 1, BGSEquipSlot* a_slot = 0, bool a_queueEquip = true, bool a_forceEquip = false, bool a_playSounds = true, bool a_applyNow = false, BGSEquipSlot* a_slotToReplace = 0);
+	};
+
+
+	class ItemList
+	{
+	public:
+		void Update(TESObjectREFR* a_owner);
+
+
+		UInt32 updates = 0;
+	};
+
+
+	class IMenu
+	{
+	public:
+		virtual ~IMenu() = default;
+	};
+
+
+	class InventoryMenu : public IMenu
+	{
+	public:
+		ItemList* itemList = &_itemList;
+
+	private:
+		ItemList _itemList;
+	};
+
+
+	template <class T>
+	class GPtr
+	{
+	public:
+		GPtr(T* a_ptr = 0) : _ptr(a_ptr) {}
+		GPtr(std::nullptr_t) : _ptr(0) {}
+
+		T* get() const { return _ptr; }
+		T* operator->() const { return _ptr; }
+		explicit operator bool() const { return _ptr != 0; }
+
+	private:
+		T* _ptr;
+	};
+
+
+	class InterfaceStrings
+	{
+	public:
+		static InterfaceStrings* GetSingleton();
+
+
+		BSFixedString inventoryMenu{ "InventoryMenu" };
+	};
+
+
+	class UI
+	{
+	public:
+		static UI* GetSingleton();
+
+		template <class E>
+		BSTEventSource<E>* GetEventSource() { return &_menuOpenCloseEventSource; }
+
+		template <class T>
+		GPtr<T> GetMenu(const BSFixedString& a_name) { return GPtr<T>(a_name == InterfaceStrings::GetSingleton()->inventoryMenu && inventoryMenuOpen ? &_inventoryMenu : 0); }
+
+		bool IsMenuOpen(const BSFixedString& a_name) { return a_name == InterfaceStrings::GetSingleton()->inventoryMenu && inventoryMenuOpen; }
+
+
+		bool inventoryMenuOpen = false;
+
+	private:
+		BSTEventSource<MenuOpenCloseEvent> _menuOpenCloseEventSource;
+		InventoryMenu _inventoryMenu;
+
+	};
+
+
+	class ScriptEventSourceHolder
+	{
+	public:
+		static ScriptEventSourceHolder* GetSingleton();
+
+		template <class E>
+		BSTEventSource<E>* GetEventSource() { return &std::get<BSTEventSource<E>>(_sources); }
+
+		template <class E>
+		void AddEventSink(BSTEventSink<E>* a_sink) { GetEventSource<E>()->AddEventSink(a_sink); }
+
+	private:
+		std::tuple<
+			BSTEventSource<TESEquipEvent>,
+			BSTEventSource<TESObjectLoadedEvent>,
+			BSTEventSource<TESContainerChangedEvent>,
+			BSTEventSource<TESSwitchRaceCompleteEvent>> _sources;
+	};
+
+
+	class TESFile
+	{
+	public:
+		const char* fileName;
+		UInt8 compileIndex;
+	};
+
+
+	class TESDataHandler
+	{
+	public:
+		static TESDataHandler* GetSingleton();
+
+		TESFile* LookupLoadedModByName(const char* a_name);
+
+
+		std::vector<TESFile> files;
+	};
+
+
+	namespace Offset
+	{
+		namespace PlayerCharacter
+		{
+			constexpr std::uintptr_t Vtbl = 0;
+		}
+	}
+}
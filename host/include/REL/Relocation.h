@@ -0,0 +1,38 @@
+#pragma once
+
+// Host stand-in for CommonLibSSE's relocation helpers
+// Offsets are taken relative to the simulator's module base, which holds the vtable slots the plugin hooks
+
+#include <cstdint>  // uintptr_t
+#include <type_traits>  // remove_pointer_t
+
+
+namespace REL
+{
+	std::uintptr_t GetModuleBase();
+
+
+	template <class T>
+	class Offset
+	{
+	public:
+		explicit Offset(std::uintptr_t a_offset) :
+			_address(GetModuleBase() + a_offset)
+		{}
+
+
+		std::remove_pointer_t<T> operator*() const
+		{
+			return *reinterpret_cast<T>(_address);
+		}
+
+
+		std::uintptr_t GetAddress() const
+		{
+			return _address;
+		}
+
+	private:
+		std::uintptr_t _address;
+	};
+}
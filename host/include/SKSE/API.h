@@ -0,0 +1,15 @@
+#pragma once
+
+// Host stand-in for the SKSE entry points of CommonLibSSE
+
+#include "SKSE/Interfaces.h"
+
+
+namespace SKSE
+{
+	bool Init(const LoadInterface* a_intfc);
+
+	const TaskInterface* GetTaskInterface();
+	const MessagingInterface* GetMessagingInterface();
+	const SerializationInterface* GetSerializationInterface();
+}
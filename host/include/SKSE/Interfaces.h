@@ -0,0 +1,96 @@
+#pragma once
+
+// Host stand-in for the SKSE interfaces the plugin uses, implemented by the simulator
+
+#include "RE/Skyrim.h"
+
+
+class TaskDelegate;
+
+
+namespace SKSE
+{
+	class SerializationInterface
+	{
+	public:
+		using EventCallback = void(SerializationInterface* a_intfc);
+
+
+		void SetUniqueID(UInt32 a_uid) const;
+		void SetSaveCallback(EventCallback* a_callback) const;
+		void SetLoadCallback(EventCallback* a_callback) const;
+		void SetRevertCallback(EventCallback* a_callback) const;
+
+		bool OpenRecord(UInt32 a_type, UInt32 a_version) const;
+		bool WriteRecordData(const void* a_buf, UInt32 a_length) const;
+		bool GetNextRecordInfo(UInt32& a_type, UInt32& a_version, UInt32& a_length) const;
+		UInt32 ReadRecordData(void* a_buf, UInt32 a_length) const;
+		bool ResolveFormID(UInt32 a_oldFormID, UInt32& a_newFormID) const;
+	};
+
+
+	class TaskInterface
+	{
+	public:
+		void AddTask(TaskDelegate* a_task) const;
+	};
+
+
+	class MessagingInterface
+	{
+	public:
+		struct Message
+		{
+			const char* sender;
+			UInt32 type;
+			UInt32 dataLen;
+			void* data;
+		};
+
+
+		using EventCallback = void(Message* a_msg);
+
+
+		enum
+		{
+			kPostLoad,
+			kPostPostLoad,
+			kPreLoadGame,
+			kPostLoadGame,
+			kSaveGame,
+			kDeleteGame,
+			kInputLoaded,
+			kNewGame,
+			kDataLoaded
+		};
+
+
+		bool RegisterListener(const char* a_sender, EventCallback* a_callback) const;
+	};
+
+
+	class QueryInterface
+	{
+	public:
+		bool IsEditor() const;
+		UInt32 RuntimeVersion() const;
+	};
+
+
+	class LoadInterface : public QueryInterface
+	{};
+
+
+	struct PluginInfo
+	{
+		enum
+		{
+			kVersion = 1
+		};
+
+
+		UInt32 infoVersion;
+		const char* name;
+		UInt32 version;
+	};
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+// Host stand-in for CommonLibSSE's logger, only its level enum is used since Log.h replaces the logging macros
+
+
+namespace SKSE
+{
+	class Logger
+	{
+	public:
+		enum class Level
+		{
+			kFatalError,
+			kError,
+			kWarning,
+			kMessage,
+			kVerboseMessage,
+			kDebugMessage
+		};
+	};
+}
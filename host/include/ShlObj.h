@@ -0,0 +1,20 @@
+#pragma once
+
+// Host stand-in for the shell folder lookup used by the log
+// Known folders resolve to the directory in DNEM_HOST_DOCUMENTS, and the lookup fails when it is not set so nothing is logged
+
+
+using HRESULT = long;
+
+
+#define FAILED(hr) (static_cast<HRESULT>(hr) < 0)
+
+
+enum
+{
+	KF_FLAG_DEFAULT = 0
+};
+
+
+HRESULT SHGetKnownFolderPath(const KNOWNFOLDERID& a_id, unsigned long a_flags, void* a_token, wchar_t** a_path);
+void CoTaskMemFree(void* a_ptr);
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>  // microseconds
+#include <cstddef>  // size_t
+#include <vector>  // vector
+
+#include "RE/Skyrim.h"
+
+
+// In-memory stand-in for the game, driving the plugin through the same engine entry points it uses in game
+// The calling thread plays the game thread: tasks queued through the SKSE task interface run when a frame is stepped
+// Equip changes apply immediately and send their equip events before the call returns
+namespace Sim
+{
+	using Armor = RE::TESObjectARMO;
+	using Slot = RE::BIPED_MODEL::BipedObjectSlot;
+	using ArmorType = RE::TESObjectARMO::ArmorType;
+	using WeaponType = RE::TESObjectWEAP::WeaponType;
+
+
+	constexpr auto kFrameTime = std::chrono::microseconds(16667);
+
+
+	// One co-save as written by the plugin's save callback
+	struct CoSave
+	{
+		struct Record
+		{
+			UInt32 type;
+			UInt32 version;
+			std::vector<UInt8> data;
+		};
+
+
+		std::vector<Record> records;
+	};
+
+
+	// Runs SKSEPlugin_Query and SKSEPlugin_Load, then sends the data loaded message
+	bool LoadPlugin();
+
+	// Runs the save callback, then the load callback against the given co-save followed by the player loaded event
+	CoSave SaveGame();
+	void LoadGame(const CoSave& a_coSave);
+
+	RE::TESObjectARMO* CreateArmor(RE::FormID a_formID, Slot a_slots, ArmorType a_armorType);
+	RE::TESObjectWEAP* CreateWeapon(RE::FormID a_formID, WeaponType a_weaponType, bool a_bound = false);
+	RE::TESAmmo* CreateAmmo(RE::FormID a_formID);
+	RE::TESObjectMISC* CreateMisc(RE::FormID a_formID);
+	RE::EnchantmentItem* CreateEnchantment(RE::FormID a_formID);
+	RE::TESRace* CreateRace(RE::FormID a_formID);
+
+	// Base container items carry no extra data and send no event, as they come from the player's base form
+	void AddBaseItem(RE::TESBoundObject* a_object, SInt32 a_count);
+	void AddItem(RE::TESBoundObject* a_object, SInt32 a_count);
+	RE::ExtraDataList* AddInstance(RE::TESBoundObject* a_object, RE::EnchantmentItem* a_enchantment, float a_health);
+	void RemoveItem(RE::TESBoundObject* a_object, SInt32 a_count);
+	void ClearInventory();
+	SInt32 GetItemCount(RE::TESBoundObject* a_object);
+
+	// Equip changes made by the player, sent through the same equip manager the plugin uses
+	void Equip(RE::TESBoundObject* a_object, RE::ExtraDataList* a_xList = 0);
+	void UnEquip(RE::TESBoundObject* a_object);
+	bool IsWorn(RE::TESBoundObject* a_object);
+	RE::ExtraDataList* GetWornExtraList(RE::TESBoundObject* a_object);
+	void SetRace(RE::TESRace* a_race);
+
+	// Weapon state changes update the player first, then send the matching animation event
+	void DrawWeapon();
+	void SheatheWeapon();
+	void SendAnimationEvent(const char* a_tag, bool a_fromPlayer = true);
+	void SetInventoryMenuOpen(bool a_open);
+
+	// Updates the player, then runs every queued task the way the game's task loop does, then waits out the rest of the frame
+	void RunFrame(std::chrono::microseconds a_frameTime = kFrameTime);
+	void RunFrames(std::size_t a_count, std::chrono::microseconds a_frameTime = kFrameTime);
+	std::size_t GetQueuedTaskCount();
+
+	// Equip animations the player played, which the shield hook suppresses for the plugin's own equips
+	std::size_t GetEquipAnimationCount();
+	UInt32 GetMenuUpdateCount();
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+// Host stand-in, the plugin reaches the task interface through SKSE/API.h
+
+#include "skse64/gamethreads.h"
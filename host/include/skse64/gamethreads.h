@@ -0,0 +1,11 @@
+#pragma once
+
+// Host stand-in for the SKSE task delegate
+
+
+class TaskDelegate
+{
+public:
+	virtual void Run() = 0;
+	virtual void Dispose() = 0;
+};
@@ -0,0 +1,5 @@
+#pragma once
+
+// Host stand-in, the plugin relocates through REL/Relocation.h
+
+#include "REL/Relocation.h"
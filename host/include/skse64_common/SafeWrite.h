@@ -0,0 +1,8 @@
+#pragma once
+
+// Host stand-in for the SKSE patch helpers, writes go straight to the simulator's memory
+
+#include <cstdint>  // uintptr_t, uint64_t
+
+
+void SafeWrite64(std::uintptr_t a_addr, std::uint64_t a_data);
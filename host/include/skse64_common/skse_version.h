@@ -0,0 +1,5 @@
+#pragma once
+
+// Host stand-in, the simulator reports the one runtime the plugin supports
+
+#define RUNTIME_VERSION_1_5_97 0x01050610
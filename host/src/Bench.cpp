@@ -0,0 +1,427 @@
+#include <algorithm>  // max_element, min
+#include <chrono>  // steady_clock, duration_cast, nanoseconds, microseconds
+#include <cstdio>  // printf, fprintf, FILE, fopen, fclose
+#include <cstdlib>  // atof, EXIT_SUCCESS, EXIT_FAILURE
+#include <cstring>  // strcmp
+#include <fstream>  // ifstream
+#include <iterator>  // size
+#include <map>  // map
+#include <sstream>  // stringstream
+#include <string>  // string, stoul, getline
+#include <utility>  // pair
+#include <vector>  // vector
+
+#include "PlayerInventory.h"  // PlayerInventory, AmmoCounts
+#include "PlayerUtil.h"  // InventoryChangesVisitor, VisitPlayerInventoryChanges
+#include "Settings.h"  // Settings
+#include "Simulator.h"
+
+
+// Times the plugin's inventory paths against synthetic inventories of increasing size
+// Results are written as JSON, and compared against a previous run's JSON when a baseline is given
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+	using Slot = Sim::Slot;
+
+
+	constexpr std::size_t kBatches = 5;
+	constexpr auto kBatchTime = std::chrono::milliseconds(20);
+	constexpr RE::FormID kFillerBase = 0x01000000;
+
+
+	struct Result
+	{
+		std::string name;
+		std::size_t entries;
+		std::size_t iterations;
+		double nsPerOp;
+	};
+
+
+	class CountingVisitor : public InventoryChangesVisitor
+	{
+	public:
+		virtual bool Accept(InventoryEntryView* a_entry, SInt32 a_count) override
+		{
+			total += a_count;
+			if (a_entry->extraLists) {
+				for (auto& xList : *a_entry->extraLists) {
+					lists += xList ? 1 : 0;
+				}
+			}
+			return true;
+		}
+
+
+		SInt64 total = 0;
+		SInt64 lists = 0;
+	};
+
+
+	struct Gear
+	{
+		RE::TESObjectARMO* helmet;
+		RE::TESObjectARMO* shield;
+		RE::TESObjectWEAP* sword;
+		RE::TESObjectWEAP* bow;
+		RE::TESAmmo* arrows;
+		RE::EnchantmentItem* enchantment;
+	};
+
+
+	Gear CreateGear()
+	{
+		auto helmetSlots = static_cast<Slot>(static_cast<UInt32>(Slot::kHead) | static_cast<UInt32>(Slot::kHair));
+		return {
+			Sim::CreateArmor(0x00012E4D, helmetSlots, Sim::ArmorType::kHeavyArmor),
+			Sim::CreateArmor(0x00012EB6, Slot::kShield, Sim::ArmorType::kHeavyArmor),
+			Sim::CreateWeapon(0x00012EB7, Sim::WeaponType::kOneHandSword),
+			Sim::CreateWeapon(0x0001CDEC, Sim::WeaponType::kBow),
+			Sim::CreateAmmo(0x0001397D),
+			Sim::CreateEnchantment(0x0007A0F6)
+		};
+	}
+
+
+	// One form per filler entry, mixed the way a hoarder's inventory is: mostly misc items, then armor, weapons and ammo
+	std::vector<RE::TESBoundObject*> CreateFiller(std::size_t a_count)
+	{
+		constexpr Slot kArmorSlots[] = { Slot::kBody, Slot::kHands, Slot::kFeet, Slot::kAmulet, Slot::kRing, Slot::kCalves };
+
+		std::vector<RE::TESBoundObject*> filler;
+		filler.reserve(a_count);
+		for (std::size_t i = 0; i < a_count; ++i) {
+			auto formID = kFillerBase + static_cast<RE::FormID>(i);
+			switch (i % 10) {
+			case 0:
+			case 1:
+			case 2:
+				filler.push_back(Sim::CreateArmor(formID, kArmorSlots[i % std::size(kArmorSlots)], i % 2 ? Sim::ArmorType::kLightArmor : Sim::ArmorType::kHeavyArmor));
+				break;
+			case 3:
+			case 4:
+				filler.push_back(Sim::CreateWeapon(formID, i % 3 ? Sim::WeaponType::kOneHandSword : Sim::WeaponType::kTwoHandSword));
+				break;
+			case 5:
+				filler.push_back(Sim::CreateAmmo(formID));
+				break;
+			default:
+				filler.push_back(Sim::CreateMisc(formID));
+				break;
+			}
+		}
+		return filler;
+	}
+
+
+	// One in twenty filler entries comes from the base container, and one in eight pieces of gear carries one or two tempered or enchanted copies
+	void Populate(const std::vector<RE::TESBoundObject*>& a_filler, std::size_t a_entries, const Gear& a_gear)
+	{
+		Sim::ClearInventory();
+
+		for (std::size_t i = 0; i < a_entries; ++i) {
+			auto object = a_filler[i];
+			if (i % 20 == 0) {
+				Sim::AddBaseItem(object, 1);
+				continue;
+			}
+
+			switch (object->GetFormType()) {
+			case RE::FormType::Armor:
+			case RE::FormType::Weapon:
+				Sim::AddItem(object, 1);
+				if (i % 8 == 0) {
+					Sim::AddInstance(object, a_gear.enchantment, 1.0F);
+					if (i % 16 == 0) {
+						Sim::AddInstance(object, 0, 1.1F);
+					}
+				}
+				break;
+			case RE::FormType::Ammo:
+				Sim::AddItem(object, 20 + static_cast<SInt32>(i % 80));
+				break;
+			default:
+				Sim::AddItem(object, 1 + static_cast<SInt32>(i % 5));
+				break;
+			}
+		}
+
+		Sim::AddItem(a_gear.helmet, 1);
+		auto enchanted = Sim::AddInstance(a_gear.helmet, a_gear.enchantment, 1.1F);
+		Sim::AddItem(a_gear.shield, 1);
+		Sim::AddItem(a_gear.sword, 1);
+		Sim::AddItem(a_gear.bow, 1);
+		Sim::AddItem(a_gear.arrows, 100);
+
+		// A fresh load drops every cache and remembered item, so each size starts cold
+		Sim::LoadGame({});
+		Sim::RunFrame(std::chrono::microseconds(0));
+
+		Sim::Equip(a_gear.sword);
+		Sim::Equip(a_gear.shield);
+		Sim::DrawWeapon();
+		Sim::Equip(a_gear.helmet, enchanted);
+		Sim::RunFrame(std::chrono::microseconds(0));
+	}
+
+
+	// Best of several batches, each sized to run for roughly kBatchTime
+	template <class Fn>
+	Result Measure(const char* a_name, std::size_t a_entries, Fn a_fn)
+	{
+		a_fn();
+
+		std::size_t iterations = 1;
+		while (true) {
+			auto start = Clock::now();
+			for (std::size_t i = 0; i < iterations; ++i) {
+				a_fn();
+			}
+			if (Clock::now() - start >= kBatchTime / 4 || iterations >= (1u << 24)) {
+				break;
+			}
+			iterations *= 2;
+		}
+		iterations *= 4;
+
+		double best = 0.0;
+		for (std::size_t batch = 0; batch < kBatches; ++batch) {
+			auto start = Clock::now();
+			for (std::size_t i = 0; i < iterations; ++i) {
+				a_fn();
+			}
+			auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+			auto perOp = static_cast<double>(ns) / iterations;
+			best = batch == 0 ? perOp : std::min(best, perOp);
+		}
+
+		std::printf("%-24s %8zu entries %12.1f ns/op\n", a_name, a_entries, best);
+		return { a_name, a_entries, iterations, best };
+	}
+
+
+	std::vector<Result> Run(const std::vector<std::size_t>& a_sizes)
+	{
+		auto gear = CreateGear();
+		auto largest = *std::max_element(a_sizes.begin(), a_sizes.end());
+		auto filler = CreateFiller(largest);
+
+		std::vector<Result> results;
+		for (auto entries : a_sizes) {
+			Populate(filler, entries, gear);
+
+			auto inventory = Inventory::PlayerInventory::GetSingleton();
+			CountingVisitor visitor;
+			results.push_back(Measure("inventory_visit", entries, [&]()
+			{
+				VisitPlayerInventoryChanges(&visitor);
+			}));
+
+			results.push_back(Measure("inventory_rebuild", entries, [&]()
+			{
+				inventory->Invalidate();
+				VisitPlayerInventoryChanges(&visitor);
+			}));
+
+			// A pickup and a drop, each followed by the visit that refreshes the changed entry
+			auto changed = filler[entries / 2];
+			results.push_back(Measure("inventory_refresh", entries, [&]()
+			{
+				Sim::AddItem(changed, 1);
+				VisitPlayerInventoryChanges(&visitor);
+				Sim::RemoveItem(changed, 1);
+				VisitPlayerInventoryChanges(&visitor);
+			}));
+
+			// Loot from a whole container, sixteen pickups settled by one visit and then dropped again
+			results.push_back(Measure("inventory_refresh_batch", entries, [&]()
+			{
+				for (std::size_t i = 0; i < 16; ++i) {
+					Sim::AddItem(filler[(entries / 16) * i], 1);
+				}
+				VisitPlayerInventoryChanges(&visitor);
+				for (std::size_t i = 0; i < 16; ++i) {
+					Sim::RemoveItem(filler[(entries / 16) * i], 1);
+				}
+				VisitPlayerInventoryChanges(&visitor);
+			}));
+
+			auto ammoCounts = Inventory::AmmoCounts::GetSingleton();
+			results.push_back(Measure("ammo_count", entries, [&]()
+			{
+				visitor.total += ammoCounts->GetCount(gear.arrows->formID);
+			}));
+
+			// Sheathing takes the helmet and shield off, drawing finds and equips them again
+			results.push_back(Measure("weapon_cycle", entries, [&]()
+			{
+				Sim::SheatheWeapon();
+				Sim::RunFrame(std::chrono::microseconds(0));
+				Sim::DrawWeapon();
+				Sim::RunFrame(std::chrono::microseconds(0));
+			}));
+
+			if (!Sim::IsWorn(gear.helmet) || !Sim::IsWorn(gear.shield)) {
+				std::fprintf(stderr, "weapon_cycle did not re-equip the helmet and shield at %zu entries\n", entries);
+			}
+		}
+		return results;
+	}
+
+
+	bool WriteJSON(const char* a_path, const std::vector<Result>& a_results)
+	{
+		auto file = std::fopen(a_path, "w");
+		if (!file) {
+			std::fprintf(stderr, "Failed to open %s\n", a_path);
+			return false;
+		}
+
+		std::fprintf(file, "{\n\t\"benchmarks\": [\n");
+		for (std::size_t i = 0; i < a_results.size(); ++i) {
+			auto& result = a_results[i];
+			std::fprintf(file, "\t\t{ \"name\": \"%s\", \"entries\": %zu, \"iterations\": %zu, \"ns_per_op\": %.1f }%s\n",
+				result.name.c_str(), result.entries, result.iterations, result.nsPerOp, i + 1 < a_results.size() ? "," : "");
+		}
+		std::fprintf(file, "\t]\n}\n");
+		std::fclose(file);
+		return true;
+	}
+
+
+	// Reads back the JSON written by WriteJSON, keyed by benchmark name and entry count
+	bool ReadJSON(const char* a_path, std::map<std::pair<std::string, std::size_t>, double>& a_out)
+	{
+		std::ifstream file(a_path);
+		if (!file) {
+			std::fprintf(stderr, "Failed to open %s\n", a_path);
+			return false;
+		}
+
+		std::stringstream buf;
+		buf << file.rdbuf();
+		auto text = buf.str();
+
+		auto value = [&](std::size_t a_from, const char* a_key) -> std::pair<std::string, std::size_t>
+		{
+			auto key = std::string("\"") + a_key + "\":";
+			auto pos = text.find(key, a_from);
+			if (pos == std::string::npos) {
+				return { {}, std::string::npos };
+			}
+			pos = text.find_first_not_of(" \t\"", pos + key.size());
+			auto end = text.find_first_of(",\"}", pos);
+			return { text.substr(pos, end - pos), end };
+		};
+
+		std::size_t pos = 0;
+		while (true) {
+			auto name = value(pos, "name");
+			if (name.second == std::string::npos) {
+				break;
+			}
+			auto entries = value(name.second, "entries");
+			auto nsPerOp = value(name.second, "ns_per_op");
+			if (entries.second == std::string::npos || nsPerOp.second == std::string::npos) {
+				break;
+			}
+			a_out[{ name.first, std::stoul(entries.first) }] = std::atof(nsPerOp.first.c_str());
+			pos = nsPerOp.second;
+		}
+		return true;
+	}
+
+
+	// Slower than the baseline by more than a_tolerance (a fraction) counts as a regression
+	std::size_t Compare(const std::vector<Result>& a_results, const std::map<std::pair<std::string, std::size_t>, double>& a_baseline, double a_tolerance)
+	{
+		std::size_t regressions = 0;
+		std::printf("\n%-24s %8s %14s %14s %9s\n", "benchmark", "entries", "baseline", "current", "change");
+		for (auto& result : a_results) {
+			auto it = a_baseline.find({ result.name, result.entries });
+			if (it == a_baseline.end() || it->second <= 0.0) {
+				std::printf("%-24s %8zu %14s %14.1f %9s\n", result.name.c_str(), result.entries, "-", result.nsPerOp, "new");
+				continue;
+			}
+
+			auto change = (result.nsPerOp - it->second) / it->second;
+			auto regressed = change > a_tolerance;
+			regressions += regressed ? 1 : 0;
+			std::printf("%-24s %8zu %14.1f %14.1f %+8.1f%%%s\n", result.name.c_str(), result.entries, it->second, result.nsPerOp, change * 100.0, regressed ? "  REGRESSION" : "");
+		}
+		return regressions;
+	}
+
+
+	void PrintUsage()
+	{
+		std::printf("usage: dnem_bench [--json <out.json>] [--baseline <old.json>] [--tolerance <fraction>] [--sizes <n,n,...>]\n");
+	}
+}
+
+
+int main(int a_argc, char* a_argv[])
+{
+	const char* jsonPath = 0;
+	const char* baselinePath = 0;
+	double tolerance = 0.15;
+	std::vector<std::size_t> sizes = { 50, 1000, 10000, 100000 };
+
+	for (int i = 1; i < a_argc; ++i) {
+		auto arg = a_argv[i];
+		auto hasValue = i + 1 < a_argc;
+		if (std::strcmp(arg, "--json") == 0 && hasValue) {
+			jsonPath = a_argv[++i];
+		} else if (std::strcmp(arg, "--baseline") == 0 && hasValue) {
+			baselinePath = a_argv[++i];
+		} else if (std::strcmp(arg, "--tolerance") == 0 && hasValue) {
+			tolerance = std::atof(a_argv[++i]);
+		} else if (std::strcmp(arg, "--sizes") == 0 && hasValue) {
+			sizes.clear();
+			std::stringstream list(a_argv[++i]);
+			std::string size;
+			while (std::getline(list, size, ',')) {
+				sizes.push_back(std::stoul(size));
+			}
+		} else {
+			PrintUsage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (sizes.empty()) {
+		PrintUsage();
+		return EXIT_FAILURE;
+	}
+
+	Settings::manageAmmo = true;
+	Settings::manageHelmet = true;
+	Settings::manageShield = true;
+
+	if (!Sim::LoadPlugin()) {
+		std::fprintf(stderr, "Failed to load the plugin\n");
+		return EXIT_FAILURE;
+	}
+
+	auto results = Run(sizes);
+
+	if (jsonPath && !WriteJSON(jsonPath, results)) {
+		return EXIT_FAILURE;
+	}
+
+	if (baselinePath) {
+		std::map<std::pair<std::string, std::size_t>, double> baseline;
+		if (!ReadJSON(baselinePath, baseline)) {
+			return EXIT_FAILURE;
+		}
+
+		auto regressions = Compare(results, baseline, tolerance);
+		if (regressions > 0) {
+			std::printf("\n%zu benchmark(s) regressed by more than %.1f%%\n", regressions, tolerance * 100.0);
+			return EXIT_FAILURE;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
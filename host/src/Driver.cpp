@@ -0,0 +1,177 @@
+#include <cstddef>  // size_t
+#include <cstdio>  // printf, remove
+#include <cstdlib>  // EXIT_SUCCESS, EXIT_FAILURE
+
+#include "Scheduler.h"  // AddTask, Priority
+#include "Settings.h"  // Settings
+#include "Trace.h"  // StartRecording, Flush, Replay, IsReplaying
+#include "Simulator.h"
+
+
+// Plays one session against the simulator: the helmet and shield follow the weapon, ammo follows the bow, and all of it survives a save
+// and a trip to the workbench, and replaying a trace of it leaves the player as it found them
+namespace
+{
+	using Slot = Sim::Slot;
+
+
+	constexpr auto kTracePath = "dnem_sim.trace";
+	constexpr std::size_t kReplayFrames = 30;
+
+
+	constexpr auto kHelmetSlots = static_cast<Slot>(static_cast<UInt32>(Slot::kHead) | static_cast<UInt32>(Slot::kHair));
+
+
+	int g_failures = 0;
+
+
+	void Check(bool a_ok, const char* a_what)
+	{
+		std::printf("%s: %s\n", a_ok ? "ok" : "FAILED", a_what);
+		if (!a_ok) {
+			++g_failures;
+		}
+	}
+
+
+	class CountTaskDelegate : public TaskDelegate
+	{
+	public:
+		explicit CountTaskDelegate(std::size_t& a_count) :
+			_count(a_count)
+		{}
+
+
+		virtual void Run() override
+		{
+			++_count;
+		}
+
+
+		virtual void Dispose() override
+		{}
+
+	private:
+		std::size_t& _count;
+	};
+}
+
+
+int main()
+{
+	Settings::manageAmmo = true;
+	Settings::manageHelmet = true;
+	Settings::manageShield = true;
+
+	auto helmet = Sim::CreateArmor(0x00012E4D, kHelmetSlots, Sim::ArmorType::kHeavyArmor);
+	auto shield = Sim::CreateArmor(0x00012EB6, Slot::kShield, Sim::ArmorType::kHeavyArmor);
+	auto sword = Sim::CreateWeapon(0x00012EB7, Sim::WeaponType::kOneHandSword);
+	auto bow = Sim::CreateWeapon(0x0001CDEC, Sim::WeaponType::kBow);
+	auto arrows = Sim::CreateAmmo(0x0001397D);
+	auto fortify = Sim::CreateEnchantment(0x0007A0F6);
+
+	if (!Sim::LoadPlugin()) {
+		std::printf("FAILED: plugin load\n");
+		return EXIT_FAILURE;
+	}
+	Sim::LoadGame({});
+	Sim::RunFrame();
+
+	Sim::AddItem(helmet, 1);
+	auto enchanted = Sim::AddInstance(helmet, fortify, 1.1F);
+	Sim::AddItem(shield, 1);
+	Sim::AddItem(sword, 1);
+	Sim::AddItem(bow, 1);
+	Sim::AddItem(arrows, 50);
+
+	Sim::Equip(sword);
+	Sim::Equip(shield);
+	Sim::DrawWeapon();
+	Sim::Equip(helmet, enchanted);
+	Sim::RunFrames(2);
+
+	Sim::SheatheWeapon();
+	Sim::RunFrames(2);
+	Check(!Sim::IsWorn(helmet), "helmet comes off when the weapon is sheathed");
+	Check(!Sim::IsWorn(shield), "shield comes off when the weapon is sheathed");
+
+	Sim::DrawWeapon();
+	Sim::RunFrames(2);
+	Check(Sim::GetWornExtraList(helmet) == enchanted, "the remembered enchanted helmet goes back on when the weapon is drawn");
+	Check(Sim::IsWorn(shield), "shield goes back on when the weapon is drawn");
+	Check(Sim::GetEquipAnimationCount() > 0, "equip animations reach the hooked vtable slot");
+
+	auto coSave = Sim::SaveGame();
+	Sim::SheatheWeapon();
+	Sim::RunFrames(2);
+	Sim::LoadGame(coSave);
+	Sim::RunFrame();
+	Sim::DrawWeapon();
+	Sim::RunFrames(2);
+	Check(Sim::GetWornExtraList(helmet) == enchanted, "the remembered helmet survives a save and load");
+
+	// Tempering at a workbench changes the copy's health while it is not worn
+	Sim::SheatheWeapon();
+	Sim::RunFrames(2);
+	enchanted->Add(new RE::ExtraHealth(1.2F));
+	Sim::DrawWeapon();
+	Sim::RunFrames(2);
+	Check(Sim::GetWornExtraList(helmet) == enchanted, "the remembered helmet is still found after it was tempered");
+
+	Sim::Equip(arrows);
+	Sim::RunFrames(2);
+	Sim::Equip(bow);
+	Sim::RunFrames(2);
+	Check(Sim::IsWorn(arrows), "the remembered ammo stays on with the bow");
+	Sim::Equip(sword);
+	Sim::RunFrames(2);
+	Check(!Sim::IsWorn(arrows), "ammo comes off with the bow");
+	Sim::Equip(bow);
+	Sim::RunFrames(2);
+	Check(Sim::IsWorn(arrows), "the remembered ammo goes back on with the bow");
+
+	Check(Trace::StartRecording(kTracePath), "the event trace opens");
+	Sim::SendAnimationEvent("weaponSheathe", false);
+	Sim::SheatheWeapon();
+	Sim::RunFrames(2);
+	Sim::DrawWeapon();
+	Sim::RunFrames(2);
+	Trace::Flush();
+
+	// Replayed against a sheathed player, the traced draw would put the helmet back on if replay reached the game
+	Sim::SheatheWeapon();
+	Sim::RunFrames(2);
+	Check(Trace::Replay(kTracePath), "the event trace replays");
+	Sim::RunFrames(kReplayFrames);
+	Check(!Trace::IsReplaying(), "the replay finishes");
+	Check(!Sim::IsWorn(helmet), "the replay leaves the helmet off");
+
+	Sim::DrawWeapon();
+	Sim::RunFrames(2);
+	Check(Sim::GetWornExtraList(helmet) == enchanted, "the remembered helmet is restored after the replay");
+	std::remove(kTracePath);
+
+	// With no budget, each frame runs a single bookkeeping task
+	Settings::taskBudget = 0;
+	std::size_t bookkept = 0;
+	std::size_t equipped = 0;
+	CountTaskDelegate bookkeeping[4] = { CountTaskDelegate(bookkept), CountTaskDelegate(bookkept), CountTaskDelegate(bookkept), CountTaskDelegate(bookkept) };
+	CountTaskDelegate equip(equipped);
+	Scheduler::AddTask(&bookkeeping[0], Scheduler::Priority::kBookkeeping);
+	Scheduler::AddTask(&bookkeeping[1], Scheduler::Priority::kBookkeeping);
+	Sim::RunFrame();
+	Check(bookkept == 1 && Sim::GetQueuedTaskCount() == 0, "bookkeeping over the budget waits for the next frame");
+	Sim::RunFrame();
+	Check(bookkept == 2, "deferred bookkeeping resumes on the next frame");
+
+	Scheduler::AddTask(&bookkeeping[2], Scheduler::Priority::kBookkeeping);
+	Scheduler::AddTask(&bookkeeping[3], Scheduler::Priority::kBookkeeping);
+	Sim::RunFrame();
+	Scheduler::AddTask(&equip, Scheduler::Priority::kEquip);
+	Check(Sim::GetQueuedTaskCount() == 1, "equip work queued during a deferral is pumped right away");
+	Sim::RunFrame();
+	Check(equipped == 1 && bookkept == 4, "the pump runs the equip work, then the deferred bookkeeping");
+
+	std::printf("%d failure(s)\n", g_failures);
+	return g_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
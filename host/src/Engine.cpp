@@ -0,0 +1,458 @@
+#include "Host.h"
+
+#include <algorithm>  // find, find_if
+#include <cstdint>  // uintptr_t
+#include <cstring>  // strcmp
+#include <memory>  // unique_ptr
+#include <mutex>  // mutex, lock_guard
+#include <string>  // string
+#include <unordered_map>  // unordered_map
+#include <unordered_set>  // unordered_set
+#include <vector>  // vector
+
+#include "RE/Skyrim.h"
+#include "REL/Relocation.h"  // GetModuleBase
+#include "skse64_common/SafeWrite.h"  // SafeWrite64
+
+
+namespace
+{
+	constexpr RE::FormID kPlayerID = 0x00000014;
+	constexpr std::size_t kVtblSize = 0x100;
+	constexpr std::size_t kUpdate = 0xAD;
+	constexpr std::size_t kOnItemEquipped = 0xB2;
+
+
+	std::unordered_map<RE::FormID, std::unique_ptr<RE::TESForm>>& GetForms()
+	{
+		static std::unordered_map<RE::FormID, std::unique_ptr<RE::TESForm>> forms;
+		return forms;
+	}
+
+
+	// Stands in for the game module, with the player's vtable at its base so Offset::PlayerCharacter::Vtbl is zero
+	std::uintptr_t* GetPlayerVtbl()
+	{
+		static std::uintptr_t* vtbl = []()
+		{
+			static std::uintptr_t table[kVtblSize] = {};
+			table[kUpdate] = GetFnAddr(&RE::PlayerCharacter::Update);
+			table[kOnItemEquipped] = GetFnAddr(&RE::PlayerCharacter::OnItemEquipped);
+			return table;
+		}();
+		return vtbl;
+	}
+
+
+	// Simulator-side indexes, so building a large inventory or equipping into one costs the simulator nothing the plugin would be timed for
+	std::unordered_map<RE::TESBoundObject*, RE::InventoryEntryData*> g_entries;
+	std::vector<RE::TESBoundObject*> g_worn;
+	std::size_t g_equipAnimations = 0;
+
+
+	void PlayEquipAnimation(RE::PlayerCharacter* a_player)
+	{
+		using func_t = function_type_t<decltype(&RE::PlayerCharacter::OnItemEquipped)>;
+		auto func = reinterpret_cast<func_t*>(GetPlayerVtbl()[kOnItemEquipped]);
+		func(a_player, true);
+	}
+
+
+	void SendEquipEvent(RE::TESBoundObject* a_object, bool a_equipped)
+	{
+		RE::TESEquipEvent event{ RE::PlayerCharacter::GetSingleton(), a_object->formID, 0, 0, a_equipped };
+		RE::ScriptEventSourceHolder::GetSingleton()->GetEventSource<RE::TESEquipEvent>()->SendEvent(&event);
+	}
+
+
+	bool Overlaps(RE::TESBoundObject* a_lhs, RE::TESBoundObject* a_rhs)
+	{
+		auto lhs = static_cast<RE::TESObjectARMO*>(a_lhs);
+		auto rhs = static_cast<RE::TESObjectARMO*>(a_rhs);
+		return (static_cast<UInt32>(lhs->GetSlotMask()) & static_cast<UInt32>(rhs->GetSlotMask())) != 0;
+	}
+
+
+	// Worn items that must come off before a_object goes on, as the game swaps out whatever shares its slots
+	std::vector<RE::TESBoundObject*> GetDisplaced(RE::TESBoundObject* a_object)
+	{
+		std::vector<RE::TESBoundObject*> displaced;
+		for (auto& worn : g_worn) {
+			if (worn == a_object || worn->GetFormType() != a_object->GetFormType()) {
+				continue;
+			}
+
+			if (!a_object->IsArmor() || Overlaps(a_object, worn)) {
+				displaced.push_back(worn);
+			}
+		}
+		return displaced;
+	}
+
+
+	SInt32 CountLists(RE::InventoryEntryData* a_entry)
+	{
+		SInt32 count = 0;
+		if (a_entry->extraLists) {
+			for (auto it = a_entry->extraLists->begin(); it != a_entry->extraLists->end(); ++it) {
+				++count;
+			}
+		}
+		return count;
+	}
+}
+
+
+namespace REL
+{
+	std::uintptr_t GetModuleBase()
+	{
+		return reinterpret_cast<std::uintptr_t>(GetPlayerVtbl());
+	}
+}
+
+
+void SafeWrite64(std::uintptr_t a_addr, UInt64 a_data)
+{
+	*reinterpret_cast<UInt64*>(a_addr) = a_data;
+}
+
+
+namespace RE
+{
+	BSFixedString::BSFixedString() :
+		BSFixedString(std::string_view())
+	{}
+
+
+	BSFixedString::BSFixedString(const char* a_string) :
+		BSFixedString(std::string_view(a_string ? a_string : ""))
+	{}
+
+
+	// Interned like the engine's string cache, so equal strings compare by pointer
+	BSFixedString::BSFixedString(std::string_view a_string)
+	{
+		static std::mutex lock;
+		static std::unordered_set<std::string> pool;
+
+		std::lock_guard<std::mutex> locker(lock);
+		auto& interned = *pool.emplace(a_string).first;
+		_data = interned.c_str();
+		_size = interned.size();
+	}
+
+
+	BSExtraData* ExtraDataList::GetByType(ExtraDataType a_type) const
+	{
+		if (!HasType(a_type)) {
+			return 0;
+		}
+
+		auto it = std::find_if(_data.begin(), _data.end(), [&](auto& a_data) { return a_data->GetType() == a_type; });
+		return it != _data.end() ? it->get() : 0;
+	}
+
+
+	void ExtraDataList::Add(BSExtraData* a_data)
+	{
+		Remove(a_data->GetType());
+		_presence.set(static_cast<std::size_t>(a_data->GetType()));
+		_data.emplace_back(a_data);
+	}
+
+
+	bool ExtraDataList::Remove(ExtraDataType a_type)
+	{
+		if (!HasType(a_type)) {
+			return false;
+		}
+
+		_presence.reset(static_cast<std::size_t>(a_type));
+		_data.erase(std::find_if(_data.begin(), _data.end(), [&](auto& a_data) { return a_data->GetType() == a_type; }));
+		return true;
+	}
+
+
+	TESForm* TESForm::LookupByID(FormID a_formID)
+	{
+		if (a_formID == kPlayerID) {
+			return PlayerCharacter::GetSingleton();
+		}
+
+		auto& forms = GetForms();
+		auto it = forms.find(a_formID);
+		return it != forms.end() ? it->second.get() : 0;
+	}
+
+
+	bool TESObjectREFR::IsPlayerRef() const
+	{
+		return formID == kPlayerID;
+	}
+
+
+	PlayerCharacter* PlayerCharacter::GetSingleton()
+	{
+		static struct Player : PlayerCharacter {} singleton;
+		return &singleton;
+	}
+
+
+	void PlayerCharacter::OnItemEquipped(bool a_playAnim)
+	{
+		if (a_playAnim) {
+			++g_equipAnimations;
+		}
+	}
+
+
+	void PlayerCharacter::Update(float)
+	{}
+
+
+	PlayerCharacter::PlayerCharacter() :
+		Actor(FormType::ActorCharacter, kPlayerID)
+	{
+		_changes = new InventoryChanges();
+		_graphManager.graphs.push_back(new BShkbAnimationGraph());
+	}
+
+
+	ActorEquipManager* ActorEquipManager::GetSingleton()
+	{
+		static ActorEquipManager singleton;
+		return &singleton;
+	}
+
+
+	void ActorEquipManager::EquipItem(Actor* a_actor, TESBoundObject* a_object, ExtraDataList* a_extraData, UInt32, BGSEquipSlot*, bool, bool, bool, bool)
+	{
+		if (a_actor && a_actor->IsPlayerRef() && a_object) {
+			Host::Equip(a_object, a_extraData);
+		}
+	}
+
+
+	void ActorEquipManager::UnequipItem(Actor* a_actor, TESBoundObject* a_object, ExtraDataList* a_extraData, UInt32, BGSEquipSlot*, bool, bool, bool, bool, BGSEquipSlot*)
+	{
+		if (a_actor && a_actor->IsPlayerRef() && a_object) {
+			Host::UnEquip(a_object, a_extraData);
+		}
+	}
+
+
+	void ItemList::Update(TESObjectREFR*)
+	{
+		++updates;
+	}
+
+
+	InterfaceStrings* InterfaceStrings::GetSingleton()
+	{
+		static InterfaceStrings singleton;
+		return &singleton;
+	}
+
+
+	UI* UI::GetSingleton()
+	{
+		static UI singleton;
+		return &singleton;
+	}
+
+
+	ScriptEventSourceHolder* ScriptEventSourceHolder::GetSingleton()
+	{
+		static ScriptEventSourceHolder singleton;
+		return &singleton;
+	}
+
+
+	TESDataHandler* TESDataHandler::GetSingleton()
+	{
+		static TESDataHandler singleton{ { { "Skyrim.esm", 0x00 }, { "Update.esm", 0x01 }, { "Dawnguard.esm", 0x02 }, { "HearthFires.esm", 0x03 }, { "Dragonborn.esm", 0x04 } } };
+		return &singleton;
+	}
+
+
+	TESFile* TESDataHandler::LookupLoadedModByName(const char* a_name)
+	{
+		for (auto& file : files) {
+			if (std::strcmp(file.fileName, a_name) == 0) {
+				return &file;
+			}
+		}
+		return 0;
+	}
+}
+
+
+namespace Host
+{
+	void RegisterForm(RE::TESForm* a_form)
+	{
+		GetForms()[a_form->formID].reset(a_form);
+	}
+
+
+	RE::InventoryEntryData* FindEntry(RE::TESBoundObject* a_object)
+	{
+		auto it = g_entries.find(a_object);
+		return it != g_entries.end() ? it->second : 0;
+	}
+
+
+	RE::InventoryEntryData* GetOrCreateEntry(RE::TESBoundObject* a_object)
+	{
+		auto entry = FindEntry(a_object);
+		if (!entry) {
+			entry = new RE::InventoryEntryData(a_object, 0);
+			RE::PlayerCharacter::GetSingleton()->GetInventoryChanges()->entryList->push_front(entry);
+			g_entries.emplace(a_object, entry);
+		}
+		return entry;
+	}
+
+
+	SInt32 GetBaseCount(RE::TESBoundObject* a_object)
+	{
+		SInt32 count = 0;
+		RE::PlayerCharacter::GetSingleton()->GetContainer()->ForEachContainerObject([&](RE::ContainerObject* a_entry) -> bool
+		{
+			if (a_entry->obj == a_object) {
+				count += a_entry->count;
+			}
+			return true;
+		});
+		return count;
+	}
+
+
+	SInt32 GetCount(RE::TESBoundObject* a_object)
+	{
+		auto entry = FindEntry(a_object);
+		return GetBaseCount(a_object) + (entry ? entry->countDelta : 0);
+	}
+
+
+	RE::ExtraDataList* FindWorn(RE::InventoryEntryData* a_entry)
+	{
+		if (a_entry && a_entry->extraLists) {
+			for (auto& xList : *a_entry->extraLists) {
+				if (xList->HasType(RE::ExtraDataType::kWorn) || xList->HasType(RE::ExtraDataType::kWornLeft)) {
+					return xList;
+				}
+			}
+		}
+		return 0;
+	}
+
+
+	// Drops the whole inventory without sending events, as a new character would start
+	void ClearInventory()
+	{
+		auto player = RE::PlayerCharacter::GetSingleton();
+		auto entryList = player->GetInventoryChanges()->entryList;
+		for (auto& entry : *entryList) {
+			if (entry->extraLists) {
+				for (auto& xList : *entry->extraLists) {
+					delete xList;
+				}
+				delete entry->extraLists;
+			}
+			delete entry;
+		}
+		*entryList = RE::BSSimpleList<RE::InventoryEntryData*>();
+		g_entries.clear();
+		g_worn.clear();
+
+		player->GetContainer()->containerObjects.clear();
+		player->currentProcess->leftHand = 0;
+		player->currentProcess->rightHand = 0;
+	}
+
+
+	// Picks the copy to wear the way the equip manager does: the given one, else a copy without extra data while any remain, else the first
+	void Equip(RE::TESBoundObject* a_object, RE::ExtraDataList* a_xList)
+	{
+		auto count = GetCount(a_object);
+		if (count <= 0) {
+			return;
+		}
+
+		auto entry = GetOrCreateEntry(a_object);
+		auto xList = a_xList;
+		if (!xList) {
+			if (count > CountLists(entry)) {
+				xList = new RE::ExtraDataList();
+			} else {
+				xList = entry->extraLists->front();
+			}
+		}
+
+		if (xList->HasType(RE::ExtraDataType::kWorn)) {
+			return;
+		}
+
+		for (auto& displaced : GetDisplaced(a_object)) {
+			UnEquip(displaced, 0);
+		}
+
+		if (xList->empty()) {
+			if (!entry->extraLists) {
+				entry->extraLists = new RE::BSSimpleList<RE::ExtraDataList*>();
+			}
+			entry->extraLists->push_front(xList);
+		}
+		xList->Add(new RE::ExtraWorn());
+		g_worn.push_back(a_object);
+
+		auto player = RE::PlayerCharacter::GetSingleton();
+		if (a_object->IsWeapon()) {
+			player->currentProcess->rightHand = a_object;
+		}
+
+		SendEquipEvent(a_object, true);
+		PlayEquipAnimation(player);
+	}
+
+
+	void UnEquip(RE::TESBoundObject* a_object, RE::ExtraDataList* a_xList)
+	{
+		auto entry = FindEntry(a_object);
+		auto xList = a_xList && (a_xList->HasType(RE::ExtraDataType::kWorn) || a_xList->HasType(RE::ExtraDataType::kWornLeft)) ? a_xList : FindWorn(entry);
+		if (!xList) {
+			return;
+		}
+
+		xList->Remove(RE::ExtraDataType::kWorn);
+		xList->Remove(RE::ExtraDataType::kWornLeft);
+		if (xList->empty()) {
+			entry->extraLists->remove(xList);
+			delete xList;
+		}
+		g_worn.erase(std::find(g_worn.begin(), g_worn.end(), a_object));
+
+		auto player = RE::PlayerCharacter::GetSingleton();
+		if (player->currentProcess->rightHand == a_object) {
+			player->currentProcess->rightHand = 0;
+		}
+
+		SendEquipEvent(a_object, false);
+	}
+
+
+	std::size_t GetEquipAnimationCount()
+	{
+		return g_equipAnimations;
+	}
+
+
+	void UpdatePlayer(float a_delta)
+	{
+		using func_t = function_type_t<decltype(&RE::PlayerCharacter::Update)>;
+		auto func = reinterpret_cast<func_t*>(GetPlayerVtbl()[kUpdate]);
+		func(RE::PlayerCharacter::GetSingleton(), a_delta);
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>  // size_t
+
+#include "Simulator.h"  // CoSave
+
+#include "RE/Skyrim.h"
+
+
+// State shared by the simulator's translation units
+namespace Host
+{
+	void RegisterForm(RE::TESForm* a_form);
+
+	RE::InventoryEntryData* FindEntry(RE::TESBoundObject* a_object);
+	RE::InventoryEntryData* GetOrCreateEntry(RE::TESBoundObject* a_object);
+	SInt32 GetBaseCount(RE::TESBoundObject* a_object);
+	SInt32 GetCount(RE::TESBoundObject* a_object);
+	RE::ExtraDataList* FindWorn(RE::InventoryEntryData* a_entry);
+	void ClearInventory();
+
+	void Equip(RE::TESBoundObject* a_object, RE::ExtraDataList* a_xList);
+	void UnEquip(RE::TESBoundObject* a_object, RE::ExtraDataList* a_xList);
+	std::size_t GetEquipAnimationCount();
+	void UpdatePlayer(float a_delta);
+
+	void RunTasks();
+	std::size_t GetQueuedTaskCount();
+	void SendMessage(UInt32 a_type);
+	void Save(Sim::CoSave& a_coSave);
+	void Load(const Sim::CoSave& a_coSave);
+}
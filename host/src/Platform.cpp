@@ -0,0 +1,79 @@
+#include <cerrno>  // errno
+#include <cstdio>  // FILE, fopen
+#include <cstdlib>  // getenv
+#include <cstring>  // strlen
+#include <ctime>  // localtime_r
+#include <filesystem>  // path, create_directories
+#include <string>  // string
+
+#include <ShlObj.h>  // SHGetKnownFolderPath, CoTaskMemFree
+
+#include "Json2Settings.h"
+
+
+namespace
+{
+	// Plugin paths are ASCII and written with Windows separators
+	std::string Narrow(const wchar_t* a_path)
+	{
+		std::string path;
+		for (; *a_path; ++a_path) {
+			path.push_back(*a_path == L'\\' ? '/' : static_cast<char>(*a_path));
+		}
+		return path;
+	}
+}
+
+
+int _wfopen_s(std::FILE** a_file, const wchar_t* a_path, const wchar_t* a_mode)
+{
+	std::filesystem::path path(Narrow(a_path));
+	std::error_code err;
+	if (path.has_parent_path()) {
+		std::filesystem::create_directories(path.parent_path(), err);
+	}
+
+	*a_file = std::fopen(path.c_str(), Narrow(a_mode).c_str());
+	return *a_file ? 0 : errno;
+}
+
+
+int localtime_s(std::tm* a_tm, const std::time_t* a_time)
+{
+	return ::localtime_r(a_time, a_tm) ? 0 : errno;
+}
+
+
+HRESULT SHGetKnownFolderPath(const KNOWNFOLDERID&, unsigned long, void*, wchar_t** a_path)
+{
+	auto folder = std::getenv("DNEM_HOST_DOCUMENTS");
+	if (!folder) {
+		return -1;
+	}
+
+	auto len = std::strlen(folder);
+	*a_path = new wchar_t[len + 1];
+	for (std::size_t i = 0; i <= len; ++i) {
+		(*a_path)[i] = static_cast<wchar_t>(folder[i]);
+	}
+	return 0;
+}
+
+
+void CoTaskMemFree(void* a_ptr)
+{
+	delete[] static_cast<wchar_t*>(a_ptr);
+}
+
+
+namespace Json2Settings
+{
+	bool Settings::loadSettings(const char*, bool)
+	{
+		return true;
+	}
+
+
+	void Settings::dump()
+	{}
+}
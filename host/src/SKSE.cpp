@@ -0,0 +1,258 @@
+#include "Host.h"
+
+#include <algorithm>  // min
+#include <cstring>  // memcpy, strcmp
+#include <deque>  // deque
+#include <mutex>  // mutex, lock_guard
+#include <utility>  // pair
+#include <vector>  // vector
+
+#include "SKSE/API.h"
+#include "SKSE/Interfaces.h"
+#include "skse64/gamethreads.h"  // TaskDelegate
+#include "skse64_common/skse_version.h"  // RUNTIME_VERSION_1_5_97
+
+
+namespace
+{
+	struct TaskQueue
+	{
+		std::mutex lock;
+		std::deque<TaskDelegate*> tasks;
+	};
+
+
+	TaskQueue& GetTaskQueue()
+	{
+		static TaskQueue queue;
+		return queue;
+	}
+
+
+	std::vector<std::pair<const char*, SKSE::MessagingInterface::EventCallback*>> g_listeners;
+
+
+	struct Serialization
+	{
+		SKSE::SerializationInterface::EventCallback* save = 0;
+		SKSE::SerializationInterface::EventCallback* load = 0;
+		SKSE::SerializationInterface::EventCallback* revert = 0;
+		Sim::CoSave* writing = 0;
+		const Sim::CoSave* reading = 0;
+		std::size_t record = 0;
+		std::size_t offset = 0;
+	} g_serialization;
+
+
+	SKSE::TaskInterface g_task;
+	SKSE::MessagingInterface g_messaging;
+	SKSE::SerializationInterface g_serializationIntfc;
+}
+
+
+namespace SKSE
+{
+	bool Init(const LoadInterface*)
+	{
+		return true;
+	}
+
+
+	const TaskInterface* GetTaskInterface()
+	{
+		return &g_task;
+	}
+
+
+	const MessagingInterface* GetMessagingInterface()
+	{
+		return &g_messaging;
+	}
+
+
+	const SerializationInterface* GetSerializationInterface()
+	{
+		return &g_serializationIntfc;
+	}
+
+
+	void SerializationInterface::SetUniqueID(UInt32) const
+	{}
+
+
+	void SerializationInterface::SetSaveCallback(EventCallback* a_callback) const
+	{
+		g_serialization.save = a_callback;
+	}
+
+
+	void SerializationInterface::SetLoadCallback(EventCallback* a_callback) const
+	{
+		g_serialization.load = a_callback;
+	}
+
+
+	void SerializationInterface::SetRevertCallback(EventCallback* a_callback) const
+	{
+		g_serialization.revert = a_callback;
+	}
+
+
+	bool SerializationInterface::OpenRecord(UInt32 a_type, UInt32 a_version) const
+	{
+		if (!g_serialization.writing) {
+			return false;
+		}
+
+		g_serialization.writing->records.push_back({ a_type, a_version, {} });
+		return true;
+	}
+
+
+	bool SerializationInterface::WriteRecordData(const void* a_buf, UInt32 a_length) const
+	{
+		if (!g_serialization.writing || g_serialization.writing->records.empty()) {
+			return false;
+		}
+
+		auto& data = g_serialization.writing->records.back().data;
+		auto bytes = static_cast<const UInt8*>(a_buf);
+		data.insert(data.end(), bytes, bytes + a_length);
+		return true;
+	}
+
+
+	// Records are handed out in the order they were written, as the co-save stores them
+	bool SerializationInterface::GetNextRecordInfo(UInt32& a_type, UInt32& a_version, UInt32& a_length) const
+	{
+		auto coSave = g_serialization.reading;
+		if (!coSave || g_serialization.record >= coSave->records.size()) {
+			return false;
+		}
+
+		auto& record = coSave->records[g_serialization.record++];
+		g_serialization.offset = 0;
+		a_type = record.type;
+		a_version = record.version;
+		a_length = static_cast<UInt32>(record.data.size());
+		return true;
+	}
+
+
+	UInt32 SerializationInterface::ReadRecordData(void* a_buf, UInt32 a_length) const
+	{
+		auto coSave = g_serialization.reading;
+		if (!coSave || g_serialization.record == 0) {
+			return 0;
+		}
+
+		auto& data = coSave->records[g_serialization.record - 1].data;
+		auto length = std::min<std::size_t>(a_length, data.size() - g_serialization.offset);
+		std::memcpy(a_buf, data.data() + g_serialization.offset, length);
+		g_serialization.offset += length;
+		return static_cast<UInt32>(length);
+	}
+
+
+	// Load order never changes in the simulator, so every form resolves to itself
+	bool SerializationInterface::ResolveFormID(UInt32 a_oldFormID, UInt32& a_newFormID) const
+	{
+		a_newFormID = a_oldFormID;
+		return true;
+	}
+
+
+	void TaskInterface::AddTask(TaskDelegate* a_task) const
+	{
+		auto& queue = GetTaskQueue();
+		std::lock_guard<std::mutex> locker(queue.lock);
+		queue.tasks.push_back(a_task);
+	}
+
+
+	bool MessagingInterface::RegisterListener(const char* a_sender, EventCallback* a_callback) const
+	{
+		g_listeners.emplace_back(a_sender, a_callback);
+		return true;
+	}
+
+
+	bool QueryInterface::IsEditor() const
+	{
+		return false;
+	}
+
+
+	UInt32 QueryInterface::RuntimeVersion() const
+	{
+		return RUNTIME_VERSION_1_5_97;
+	}
+}
+
+
+namespace Host
+{
+	// Tasks queued while the loop runs are picked up by the same loop, as SKSE does
+	void RunTasks()
+	{
+		auto& queue = GetTaskQueue();
+		while (true) {
+			TaskDelegate* task;
+			{
+				std::lock_guard<std::mutex> locker(queue.lock);
+				if (queue.tasks.empty()) {
+					break;
+				}
+				task = queue.tasks.front();
+				queue.tasks.pop_front();
+			}
+
+			task->Run();
+			task->Dispose();
+		}
+	}
+
+
+	std::size_t GetQueuedTaskCount()
+	{
+		auto& queue = GetTaskQueue();
+		std::lock_guard<std::mutex> locker(queue.lock);
+		return queue.tasks.size();
+	}
+
+
+	void SendMessage(UInt32 a_type)
+	{
+		SKSE::MessagingInterface::Message msg{ "SKSE", a_type, 0, 0 };
+		for (auto& listener : g_listeners) {
+			if (std::strcmp(listener.first, "SKSE") == 0) {
+				listener.second(&msg);
+			}
+		}
+	}
+
+
+	void Save(Sim::CoSave& a_coSave)
+	{
+		if (g_serialization.save) {
+			g_serialization.writing = &a_coSave;
+			g_serialization.save(const_cast<SKSE::SerializationInterface*>(&g_serializationIntfc));
+			g_serialization.writing = 0;
+		}
+	}
+
+
+	void Load(const Sim::CoSave& a_coSave)
+	{
+		if (g_serialization.revert) {
+			g_serialization.revert(const_cast<SKSE::SerializationInterface*>(&g_serializationIntfc));
+		}
+
+		if (g_serialization.load) {
+			g_serialization.reading = &a_coSave;
+			g_serialization.record = 0;
+			g_serialization.load(const_cast<SKSE::SerializationInterface*>(&g_serializationIntfc));
+			g_serialization.reading = 0;
+		}
+	}
+}
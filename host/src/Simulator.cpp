@@ -0,0 +1,299 @@
+#include "Simulator.h"
+
+#include <algorithm>  // min
+#include <chrono>  // duration, steady_clock
+#include <thread>  // sleep_until
+
+#include "Host.h"
+
+#include "SKSE/Interfaces.h"
+#include "RE/Skyrim.h"
+
+
+extern "C" {
+	bool SKSEPlugin_Query(const SKSE::QueryInterface* a_skse, SKSE::PluginInfo* a_info);
+	bool SKSEPlugin_Load(const SKSE::LoadInterface* a_skse);
+}
+
+
+namespace
+{
+	template <class T, class... Args>
+	T* CreateForm(Args... a_args)
+	{
+		auto form = new T(a_args...);
+		Host::RegisterForm(form);
+		return form;
+	}
+
+
+	void SendContainerChangedEvent(RE::TESBoundObject* a_object, SInt32 a_count)
+	{
+		RE::TESContainerChangedEvent event{ a_count < 0 ? 0x00000014u : 0, a_count < 0 ? 0 : 0x00000014u, a_object->formID, a_count < 0 ? -a_count : a_count, 0, 0 };
+		RE::ScriptEventSourceHolder::GetSingleton()->GetEventSource<RE::TESContainerChangedEvent>()->SendEvent(&event);
+	}
+}
+
+
+namespace Sim
+{
+	bool LoadPlugin()
+	{
+		SKSE::LoadInterface intfc;
+		SKSE::PluginInfo info;
+		if (!SKSEPlugin_Query(&intfc, &info) || !SKSEPlugin_Load(&intfc)) {
+			return false;
+		}
+
+		Host::SendMessage(SKSE::MessagingInterface::kDataLoaded);
+		return true;
+	}
+
+
+	CoSave SaveGame()
+	{
+		CoSave coSave;
+		Host::Save(coSave);
+		return coSave;
+	}
+
+
+	void LoadGame(const CoSave& a_coSave)
+	{
+		Host::Load(a_coSave);
+
+		RE::TESObjectLoadedEvent event{ RE::PlayerCharacter::GetSingleton()->formID, true };
+		RE::ScriptEventSourceHolder::GetSingleton()->GetEventSource<RE::TESObjectLoadedEvent>()->SendEvent(&event);
+		Host::SendMessage(SKSE::MessagingInterface::kPostLoadGame);
+	}
+
+
+	RE::TESObjectARMO* CreateArmor(RE::FormID a_formID, Slot a_slots, ArmorType a_armorType)
+	{
+		return CreateForm<RE::TESObjectARMO>(a_formID, a_slots, a_armorType);
+	}
+
+
+	RE::TESObjectWEAP* CreateWeapon(RE::FormID a_formID, WeaponType a_weaponType, bool a_bound)
+	{
+		return CreateForm<RE::TESObjectWEAP>(a_formID, a_weaponType, a_bound);
+	}
+
+
+	RE::TESAmmo* CreateAmmo(RE::FormID a_formID)
+	{
+		return CreateForm<RE::TESAmmo>(a_formID);
+	}
+
+
+	RE::TESObjectMISC* CreateMisc(RE::FormID a_formID)
+	{
+		return CreateForm<RE::TESObjectMISC>(a_formID);
+	}
+
+
+	RE::EnchantmentItem* CreateEnchantment(RE::FormID a_formID)
+	{
+		return CreateForm<RE::EnchantmentItem>(a_formID);
+	}
+
+
+	RE::TESRace* CreateRace(RE::FormID a_formID)
+	{
+		return CreateForm<RE::TESRace>(a_formID);
+	}
+
+
+	void AddBaseItem(RE::TESBoundObject* a_object, SInt32 a_count)
+	{
+		RE::PlayerCharacter::GetSingleton()->GetContainer()->containerObjects.push_back({ a_count, a_object });
+	}
+
+
+	void AddItem(RE::TESBoundObject* a_object, SInt32 a_count)
+	{
+		Host::GetOrCreateEntry(a_object)->countDelta += a_count;
+		SendContainerChangedEvent(a_object, a_count);
+	}
+
+
+	RE::ExtraDataList* AddInstance(RE::TESBoundObject* a_object, RE::EnchantmentItem* a_enchantment, float a_health)
+	{
+		auto xList = new RE::ExtraDataList();
+		if (a_enchantment) {
+			xList->Add(new RE::ExtraEnchantment(a_enchantment));
+		}
+		if (a_health != 1.0F) {
+			xList->Add(new RE::ExtraHealth(a_health));
+		}
+
+		auto entry = Host::GetOrCreateEntry(a_object);
+		if (!xList->empty()) {
+			if (!entry->extraLists) {
+				entry->extraLists = new RE::BSSimpleList<RE::ExtraDataList*>();
+			}
+			entry->extraLists->push_front(xList);
+		} else {
+			delete xList;
+			xList = 0;
+		}
+		++entry->countDelta;
+
+		SendContainerChangedEvent(a_object, 1);
+		return xList;
+	}
+
+
+	// Removes copies without extra data first, the way the game hands out plain copies before unique ones
+	void RemoveItem(RE::TESBoundObject* a_object, SInt32 a_count)
+	{
+		auto entry = Host::GetOrCreateEntry(a_object);
+		auto count = std::min(a_count, Host::GetCount(a_object));
+		for (auto i = 0; i < count; ++i) {
+			SInt32 lists = 0;
+			if (entry->extraLists) {
+				for (auto it = entry->extraLists->begin(); it != entry->extraLists->end(); ++it) {
+					++lists;
+				}
+			}
+
+			if (Host::GetCount(a_object) <= lists) {
+				auto xList = entry->extraLists->front();
+				if (xList->HasType(RE::ExtraDataType::kWorn) || xList->HasType(RE::ExtraDataType::kWornLeft)) {
+					Host::UnEquip(a_object, xList);
+				}
+				entry->extraLists->remove(xList);
+				delete xList;
+			}
+			--entry->countDelta;
+		}
+
+		if (count > 0) {
+			SendContainerChangedEvent(a_object, -count);
+		}
+	}
+
+
+	void ClearInventory()
+	{
+		Host::ClearInventory();
+	}
+
+
+	SInt32 GetItemCount(RE::TESBoundObject* a_object)
+	{
+		return Host::GetCount(a_object);
+	}
+
+
+	void Equip(RE::TESBoundObject* a_object, RE::ExtraDataList* a_xList)
+	{
+		RE::ActorEquipManager::GetSingleton()->EquipItem(RE::PlayerCharacter::GetSingleton(), a_object, a_xList);
+	}
+
+
+	void UnEquip(RE::TESBoundObject* a_object)
+	{
+		RE::ActorEquipManager::GetSingleton()->UnequipItem(RE::PlayerCharacter::GetSingleton(), a_object);
+	}
+
+
+	bool IsWorn(RE::TESBoundObject* a_object)
+	{
+		return GetWornExtraList(a_object) != 0;
+	}
+
+
+	RE::ExtraDataList* GetWornExtraList(RE::TESBoundObject* a_object)
+	{
+		return Host::FindWorn(Host::FindEntry(a_object));
+	}
+
+
+	void SetRace(RE::TESRace* a_race)
+	{
+		auto player = RE::PlayerCharacter::GetSingleton();
+		player->race = a_race;
+
+		RE::TESSwitchRaceCompleteEvent event{ player };
+		RE::ScriptEventSourceHolder::GetSingleton()->GetEventSource<RE::TESSwitchRaceCompleteEvent>()->SendEvent(&event);
+	}
+
+
+	void DrawWeapon()
+	{
+		RE::PlayerCharacter::GetSingleton()->weaponDrawn = true;
+		SendAnimationEvent("weaponDraw");
+	}
+
+
+	void SheatheWeapon()
+	{
+		RE::PlayerCharacter::GetSingleton()->weaponDrawn = false;
+		SendAnimationEvent("weaponSheathe");
+	}
+
+
+	// Events from other actors reach the same graph, which is how the plugin's holder filter sees them
+	void SendAnimationEvent(const char* a_tag, bool a_fromPlayer)
+	{
+		static RE::TESObjectREFR other(RE::FormType::None, 0xFF000001);
+
+		auto player = RE::PlayerCharacter::GetSingleton();
+		RE::BSAnimationGraphManagerPtr manager;
+		player->GetAnimationGraphManager(manager);
+
+		RE::BSAnimationGraphEvent event{ a_tag, a_fromPlayer ? player : &other, "" };
+		manager->graphs.front()->GetEventSource<RE::BSAnimationGraphEvent>()->SendEvent(&event);
+	}
+
+
+	void SetInventoryMenuOpen(bool a_open)
+	{
+		auto ui = RE::UI::GetSingleton();
+		ui->inventoryMenuOpen = a_open;
+
+		RE::MenuOpenCloseEvent event{ RE::InterfaceStrings::GetSingleton()->inventoryMenu, a_open };
+		ui->GetEventSource<RE::MenuOpenCloseEvent>()->SendEvent(&event);
+	}
+
+
+	void RunFrame(std::chrono::microseconds a_frameTime)
+	{
+		auto end = std::chrono::steady_clock::now() + a_frameTime;
+		Host::UpdatePlayer(std::chrono::duration<float>(a_frameTime).count());
+		Host::RunTasks();
+		std::this_thread::sleep_until(end);
+	}
+
+
+	void RunFrames(std::size_t a_count, std::chrono::microseconds a_frameTime)
+	{
+		for (std::size_t i = 0; i < a_count; ++i) {
+			RunFrame(a_frameTime);
+		}
+	}
+
+
+	std::size_t GetQueuedTaskCount()
+	{
+		return Host::GetQueuedTaskCount();
+	}
+
+
+	std::size_t GetEquipAnimationCount()
+	{
+		return Host::GetEquipAnimationCount();
+	}
+
+
+	UInt32 GetMenuUpdateCount()
+	{
+		auto ui = RE::UI::GetSingleton();
+		auto wasOpen = ui->inventoryMenuOpen;
+		ui->inventoryMenuOpen = true;
+		auto menu = ui->GetMenu<RE::InventoryMenu>(RE::InterfaceStrings::GetSingleton()->inventoryMenu);
+		ui->inventoryMenuOpen = wasOpen;
+		return menu->itemList->updates;
+	}
+}
@@ -2,6 +2,8 @@
 
 #include "skse64/gamethreads.h"  // TaskDelegate
 
+#include <atomic>  // atomic
+
 #include "ISerializableForm.h"  // ISerializableForm, kInvalid
 #include "PlayerUtil.h"  // InventoryChangesVisitor
 
@@ -28,23 +30,36 @@ namespace Ammo
 	};
 
 
-	class DelayedWeaponTaskDelegate : public TaskDelegate
+	// Lock-free handoff of a form ID from the event sink to a task
+	// Every post bumps a sequence number, so a task only clears the post it actually consumed
+	class FormMailbox
 	{
 	public:
-		class Visitor : public InventoryChangesVisitor
+		struct Letter
 		{
-		public:
-			Visitor();
-			virtual ~Visitor() = default;
+			UInt32 formID;
+			UInt32 sequence;
+		};
 
-			virtual bool Accept(RE::InventoryEntryData* a_entry, SInt32 a_count) override;
-			SInt32 Count() const;
 
-		private:
-			SInt32 _count;
-		};
+		FormMailbox();
 
+		void Post(UInt32 a_formID);
+		Letter Peek() const;
+		bool Clear(const Letter& a_letter);
 
+	private:
+		static UInt64 Pack(UInt32 a_formID, UInt32 a_sequence);
+		static Letter Unpack(UInt64 a_slot);
+
+
+		std::atomic<UInt64> _slot;
+	};
+
+
+	class DelayedWeaponTaskDelegate : public TaskDelegate
+	{
+	public:
 		virtual void Run() override;
 		virtual void Dispose() override;
 	};
@@ -56,7 +71,13 @@ namespace Ammo
 		class Visitor : public InventoryChangesVisitor
 		{
 		public:
-			virtual bool Accept(RE::InventoryEntryData* a_entry, SInt32 a_count) override;
+			explicit Visitor(UInt32 a_formID);
+			virtual ~Visitor() = default;
+
+			virtual bool Accept(InventoryEntryView* a_entry, SInt32 a_count) override;
+
+		private:
+			UInt32 _formID;
 		};
 
 
@@ -65,36 +86,17 @@ namespace Ammo
 	};
 
 
-	class TESEquipEventHandler : public RE::BSTEventSink<RE::TESEquipEvent>
+	// Equip hooks called by Events::TESEquipEventHandler for weapons and ammo
+	struct EquipHandler
 	{
-	public:
-		using EventResult = RE::BSEventNotifyControl;
-
-
 		class Visitor : public InventoryChangesVisitor
 		{
 		public:
-			virtual bool Accept(RE::InventoryEntryData* a_entry, SInt32 a_count) override;
+			virtual bool Accept(InventoryEntryView* a_entry, SInt32 a_count) override;
 		};
 
 
-		static TESEquipEventHandler* GetSingleton();
-		virtual EventResult ProcessEvent(const RE::TESEquipEvent* a_event, RE::BSTEventSource<RE::TESEquipEvent>* a_eventSource) override;
-
-	protected:
-		TESEquipEventHandler() = default;
-		TESEquipEventHandler(const TESEquipEventHandler&) = delete;
-		TESEquipEventHandler(TESEquipEventHandler&&) = delete;
-		virtual ~TESEquipEventHandler() = default;
-
-		TESEquipEventHandler& operator=(const TESEquipEventHandler&) = delete;
-		TESEquipEventHandler& operator=(TESEquipEventHandler&&) = delete;
+		static bool Enabled();
+		static void OnEquip(RE::TESForm* a_form, bool a_equipped);
 	};
-
-
-	namespace
-	{
-		UInt32 g_equippedAmmoFormID = kInvalid;
-		UInt32 g_equippedWeaponFormID = kInvalid;
-	}
 }
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "FNV1A.h"  // hash_64_fnv1a_const, hash_64_fnv1a
+#include "FNV1A.h"  // hash_64_fnv1a_const, hash_64_fnv1a, hash_64_fnv1a_lower
 
 #include "RE/Skyrim.h"
 
@@ -16,3 +16,4 @@ enum class Anim : std::uint64_t
 
 Anim HashAnimation(const char* a_str, std::uint32_t a_len);
 Anim HashAnimation(const RE::BSFixedString& a_str);
+void ClearAnimationCache();
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <cstddef>  // size_t
+#include <vector>  // vector
+
+#include "ISerializableForm.h"  // kInvalid, SlotRecord
+#include "ItemFingerprint.h"  // ItemFingerprint
+#include "PlayerUtil.h"  // InventoryChangesVisitor, InventoryTaskDelegate, EquipIntent, QueueInventoryTask, EquipPlayerItem, UnEquipPlayerItem
+#include "TaskPool.h"  // TaskPool
+#include "WornSlots.h"  // WornSlots
+
+#include "RE/Skyrim.h"
+
+
+// Defaults for the optional hooks of a slot policy
+// A policy derives from this and shadows whichever hooks it needs
+struct SlotPolicy
+{
+	static bool CanEquip() { return true; }
+	static void OnBeforeEquip() {}
+	static void OnTailCombatIdle() {}
+};
+
+
+// Generates the task, visitors, event hooks and serialization for one managed armor slot
+// Policy requirements:
+//	using Data								ISerializableForm-like singleton holding the remembered item
+//	kName, kRecordType, kSlots				log name, co-save slot type code, biped slots routed to this slot
+//	kUnEquipSlot							biped slot whose worn armor is unequipped on sheathe
+//	bool Enabled()							setting gate
+//	bool IsRemembered(entry, count, xList)	entry is the remembered item, xList the instance to equip on draw
+//	bool IsRememberedInstance(instance)		instance is the remembered item, used to skip the equip when it is already worn
+//	bool IsManagedArmor(armor)				worn armor in kUnEquipSlot that should be unequipped on sheathe
+//	void OnEquip(armor, equipped)			equip event for armor covering kSlots
+template <class Policy>
+class EquipSlotManager
+{
+public:
+	using Data = typename Policy::Data;
+
+
+	static constexpr auto kName = Policy::kName;
+	static constexpr auto kRecordType = Policy::kRecordType;
+	static constexpr auto kSlots = Policy::kSlots;
+
+
+	class EquipVisitor : public InventoryChangesVisitor
+	{
+	public:
+		virtual bool Accept(InventoryEntryView* a_entry, SInt32 a_count) override
+		{
+			RE::ExtraDataList* xList = 0;
+			if (!Policy::IsRemembered(a_entry, a_count, xList)) {
+				return true;
+			}
+
+			Policy::OnBeforeEquip();
+			auto armor = static_cast<RE::TESObjectARMO*>(a_entry->object);
+			EquipPlayerItem(armor, xList, 1, armor->equipSlot);
+			return false;
+		}
+	};
+
+
+	class SlotTaskDelegate : public InventoryTaskDelegate
+	{
+	public:
+		SlotTaskDelegate() :
+			_state(EquipIntent::State::kNone),
+			_equipVisitor()
+		{}
+
+		virtual ~SlotTaskDelegate() = default;
+
+
+		virtual void UnEquip() override
+		{
+			_state = _intent.Take();
+			if (_state == EquipIntent::State::kUnEquip) {
+				UnEquipWorn();
+			}
+		}
+
+
+		virtual InventoryChangesVisitor* Prepare() override
+		{
+			if (_state != EquipIntent::State::kEquip) {
+				return 0;
+			}
+
+			auto formID = Data::GetSingleton()->GetFormID();
+			if (formID == kInvalid || !Policy::CanEquip() || IsRememberedWorn(formID)) {
+				return 0;
+			}
+			return &_equipVisitor;
+		}
+
+
+		virtual void Dispose() override
+		{
+			TaskPool<SlotTaskDelegate>::Release(this);
+		}
+
+	private:
+		// The worn item comes straight from the slot table, so unequipping needs no inventory visit
+		// Its worn extra list is passed along so the engine unequips that copy when several are held
+		static void UnEquipWorn()
+		{
+			auto formID = Inventory::WornSlots::GetSingleton()->GetItem(Policy::kUnEquipSlot);
+			if (formID == kInvalid) {
+				return;
+			}
+
+			auto armor = RE::TESForm::LookupByID<RE::TESObjectARMO>(formID);
+			if (armor && Policy::IsManagedArmor(armor)) {
+				auto xList = Inventory::WornSlots::GetSingleton()->GetExtraList(formID);
+				UnEquipPlayerItem(armor, xList, 1, armor->equipSlot);
+			}
+		}
+
+
+		// Another copy of the remembered form may be the one worn, so the worn instance is compared rather than the base form
+		static bool IsRememberedWorn(FormID a_formID)
+		{
+			auto wornSlots = Inventory::WornSlots::GetSingleton();
+			if (!wornSlots->IsWorn(a_formID)) {
+				return false;
+			}
+
+			auto armor = RE::TESForm::LookupByID<RE::TESObjectARMO>(a_formID);
+			return armor && Policy::IsRememberedInstance(ItemFingerprint(armor, wornSlots->GetExtraList(a_formID)));
+		}
+
+
+		EquipIntent::State _state;
+		EquipVisitor _equipVisitor;
+	};
+
+
+	EquipSlotManager() = delete;
+
+
+	static bool Enabled()
+	{
+		return Policy::Enabled();
+	}
+
+
+	static void Queue(bool a_equip)
+	{
+		if (_intent.Post(a_equip)) {
+			QueueInventoryTask(TaskPool<SlotTaskDelegate>::Create());
+		}
+	}
+
+
+	static std::size_t GetDroppedCount()
+	{
+		return _intent.GetDroppedCount();
+	}
+
+
+	static void OnWeaponDraw()
+	{
+		Queue(true);
+	}
+
+
+	static void OnWeaponSheathe()
+	{
+		Queue(false);
+	}
+
+
+	static void OnTailCombatIdle()
+	{
+		Policy::OnTailCombatIdle();
+	}
+
+
+	static void OnEquip(RE::TESObjectARMO* a_armor, bool a_equipped)
+	{
+		Policy::OnEquip(a_armor, a_equipped);
+	}
+
+
+	static void Clear()
+	{
+		Data::GetSingleton()->Clear();
+	}
+
+
+	// Slots with nothing remembered are left out of the co-save
+	static void Save(std::vector<SlotRecord>& a_records)
+	{
+		SlotRecord record = { kRecordType };
+		Data::GetSingleton()->Save(record);
+		if (record.formID != kInvalid) {
+			a_records.push_back(record);
+		}
+	}
+
+
+	static void Load(const SlotRecord& a_record)
+	{
+		Data::GetSingleton()->Load(a_record);
+		_DMESSAGE("Loaded %s (%08X)", kName, a_record.formID);
+	}
+
+private:
+	static inline EquipIntent _intent;
+};
+
+
+// Compile-time list of managed slots, used by the shared event sinks and the co-save callbacks
+template <class... Managers>
+struct EquipSlotTable
+{
+	EquipSlotTable() = delete;
+
+
+	static bool Enabled()
+	{
+		return (Managers::Enabled() || ...);
+	}
+
+
+	static void OnWeaponDraw()
+	{
+		((Managers::Enabled() ? Managers::OnWeaponDraw() : void()), ...);
+	}
+
+
+	static void OnWeaponSheathe()
+	{
+		((Managers::Enabled() ? Managers::OnWeaponSheathe() : void()), ...);
+	}
+
+
+	static void OnTailCombatIdle()
+	{
+		((Managers::Enabled() ? Managers::OnTailCombatIdle() : void()), ...);
+	}
+
+
+	static void OnEquip(RE::TESObjectARMO* a_armor, bool a_equipped)
+	{
+		((Managers::Enabled() && a_armor->HasPartOf(Managers::kSlots) ? Managers::OnEquip(a_armor, a_equipped) : void()), ...);
+	}
+
+
+	static void Clear()
+	{
+		(Managers::Clear(), ...);
+	}
+
+
+	static void Save(std::vector<SlotRecord>& a_records)
+	{
+		(Managers::Save(a_records), ...);
+	}
+
+
+	// Returns false if no managed slot owns the record's type code
+	static bool Load(const SlotRecord& a_record)
+	{
+		bool found = false;
+		((!found && a_record.type == Managers::kRecordType ? (found = true, Managers::Load(a_record), void()) : void()), ...);
+		return found;
+	}
+};
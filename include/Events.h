@@ -0,0 +1,107 @@
+#pragma once
+
+#include "skse64/gamethreads.h"  // TaskDelegate
+
+#include "Animations.h"  // Anim
+
+#include "RE/Skyrim.h"
+
+
+namespace Events
+{
+	// Single player graph sink shared by every managed slot
+	// Classifies each event once, then fans it out to the enabled modules
+	class BSAnimationGraphEventHandler : public RE::BSTEventSink<RE::BSAnimationGraphEvent>
+	{
+	public:
+		using EventResult = RE::BSEventNotifyControl;
+
+		static BSAnimationGraphEventHandler* GetSingleton();
+		virtual EventResult ProcessEvent(const RE::BSAnimationGraphEvent* a_event, RE::BSTEventSource<RE::BSAnimationGraphEvent>* a_eventSource) override;
+
+	protected:
+		BSAnimationGraphEventHandler() = default;
+		BSAnimationGraphEventHandler(const BSAnimationGraphEventHandler&) = delete;
+		BSAnimationGraphEventHandler(BSAnimationGraphEventHandler&&) = delete;
+		virtual ~BSAnimationGraphEventHandler() = default;
+
+		BSAnimationGraphEventHandler& operator=(const BSAnimationGraphEventHandler&) = delete;
+		BSAnimationGraphEventHandler& operator=(BSAnimationGraphEventHandler&&) = delete;
+	};
+
+
+	// Single equip sink shared by every managed slot
+	// Drops non-player events up front, resolves the form once, then routes it by form type and biped slot
+	class TESEquipEventHandler : public RE::BSTEventSink<RE::TESEquipEvent>
+	{
+	public:
+		using EventResult = RE::BSEventNotifyControl;
+
+		static TESEquipEventHandler* GetSingleton();
+		virtual EventResult ProcessEvent(const RE::TESEquipEvent* a_event, RE::BSTEventSource<RE::TESEquipEvent>* a_eventSource) override;
+
+	protected:
+		TESEquipEventHandler() = default;
+		TESEquipEventHandler(const TESEquipEventHandler&) = delete;
+		TESEquipEventHandler(TESEquipEventHandler&&) = delete;
+		virtual ~TESEquipEventHandler() = default;
+
+		TESEquipEventHandler& operator=(const TESEquipEventHandler&) = delete;
+		TESEquipEventHandler& operator=(TESEquipEventHandler&&) = delete;
+	};
+
+
+	class TESObjectLoadedEventHandler : public RE::BSTEventSink<RE::TESObjectLoadedEvent>
+	{
+	public:
+		using EventResult = RE::BSEventNotifyControl;
+
+		static TESObjectLoadedEventHandler* GetSingleton();
+		virtual EventResult ProcessEvent(const RE::TESObjectLoadedEvent* a_event, RE::BSTEventSource<RE::TESObjectLoadedEvent>* a_eventSource) override;
+
+	protected:
+		TESObjectLoadedEventHandler() = default;
+		TESObjectLoadedEventHandler(const TESObjectLoadedEventHandler&) = delete;
+		TESObjectLoadedEventHandler(TESObjectLoadedEventHandler&&) = delete;
+		virtual ~TESObjectLoadedEventHandler() = default;
+
+		TESObjectLoadedEventHandler& operator=(const TESObjectLoadedEventHandler&) = delete;
+		TESObjectLoadedEventHandler& operator=(TESObjectLoadedEventHandler&&) = delete;
+	};
+
+
+	class TESSwitchRaceCompleteEventHandler : public RE::BSTEventSink<RE::TESSwitchRaceCompleteEvent>
+	{
+	public:
+		using EventResult = RE::BSEventNotifyControl;
+
+		static TESSwitchRaceCompleteEventHandler* GetSingleton();
+		virtual EventResult ProcessEvent(const RE::TESSwitchRaceCompleteEvent* a_event, RE::BSTEventSource<RE::TESSwitchRaceCompleteEvent>* a_eventSource) override;
+
+	protected:
+		TESSwitchRaceCompleteEventHandler() = default;
+		TESSwitchRaceCompleteEventHandler(const TESSwitchRaceCompleteEventHandler&) = delete;
+		TESSwitchRaceCompleteEventHandler(TESSwitchRaceCompleteEventHandler&&) = delete;
+		virtual ~TESSwitchRaceCompleteEventHandler() = default;
+
+		TESSwitchRaceCompleteEventHandler& operator=(const TESSwitchRaceCompleteEventHandler&) = delete;
+		TESSwitchRaceCompleteEventHandler& operator=(TESSwitchRaceCompleteEventHandler&&) = delete;
+	};
+
+
+	class AnimGraphSinkDelegate : public TaskDelegate
+	{
+	public:
+		virtual void Run() override;
+		virtual void Dispose() override;
+	};
+
+
+	// Handler bodies, shared by the sinks and the trace replay
+	void DispatchAnimation(Anim a_anim);
+	void DispatchEquip(RE::FormID a_formID, bool a_equipped);
+	void DispatchPlayerLoaded();
+
+	bool AnimationEventsEnabled();
+	bool EquipEventsEnabled();
+}
@@ -1,6 +1,12 @@
 #pragma once
 
 #include <stdint.h>
+#include <cstddef>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define FNV1A_SSE2
+#endif
 
 
 //fnv1a 32 and 64 bit hash functions
@@ -41,6 +47,51 @@ inline const std::uint64_t hash_64_fnv1a(const void* a_key, const std::uint64_t
 } //hash_64_fnv1a
 
 
+// case insensitive 64 bit fnv1a, hashes the ascii lowercase of the key in place without copying it
+// gives the same values as hash_64_fnv1a on a lowercased copy, and as hash_64_fnv1a_const on lowercase literals
+// keys of 16 bytes or more are folded 16 at a time with sse2
+
+
+inline std::uint64_t hash_64_fnv1a_lower(const char* a_key, const std::size_t a_len) noexcept
+{
+	std::uint64_t hash = 0xcbf29ce484222325;
+	std::uint64_t prime = 0x100000001b3;
+	std::size_t i = 0;
+
+#ifdef FNV1A_SSE2
+	if (a_len >= 16) {
+		const __m128i lowerBound = _mm_set1_epi8('A' - 1);
+		const __m128i upperBound = _mm_set1_epi8('Z' + 1);
+		const __m128i caseBit = _mm_set1_epi8(0x20);
+		alignas(16) std::uint8_t folded[16];
+
+		for (; i + 16 <= a_len; i += 16) {
+			__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a_key + i));
+			__m128i isUpper = _mm_and_si128(_mm_cmpgt_epi8(chunk, lowerBound), _mm_cmplt_epi8(chunk, upperBound));
+			chunk = _mm_or_si128(chunk, _mm_and_si128(isUpper, caseBit));
+			_mm_store_si128(reinterpret_cast<__m128i*>(folded), chunk);
+
+			for (auto value : folded) {
+				hash = hash ^ value;
+				hash *= prime;
+			}
+		}
+	}
+#endif
+
+	for (; i < a_len; ++i) {
+		std::uint8_t value = a_key[i];
+		if (value >= 'A' && value <= 'Z') {
+			value += 'a' - 'A';
+		}
+		hash = hash ^ value;
+		hash *= prime;
+	}
+
+	return hash;
+} //hash_64_fnv1a_lower
+
+
 // FNV1a c++11 constexpr compile time hash functions, 32 and 64 bit
   // str should be a null terminated string literal, value should be left out
   // e.g hash_32_fnv1a_const("example")
@@ -16,6 +16,11 @@ namespace
 }
 
 
+// Resolved form pointers are cached until the generation changes (on game load)
+UInt32 GetFormCacheGeneration();
+void InvalidateFormCache();
+
+
 template <typename T>
 class Form
 {
@@ -26,7 +31,9 @@ public:
 	Form(UInt32 a_rawFormID, std::string a_pluginName) :
 		_rawFormID(a_rawFormID),
 		_loadedFormID(kInvalid),
-		_pluginName(a_pluginName)
+		_pluginName(a_pluginName),
+		_form(0),
+		_cacheGeneration(0)
 	{}
 
 
@@ -36,6 +43,18 @@ public:
 			return 0;
 		}
 
+		auto generation = GetFormCacheGeneration();
+		if (_form && _cacheGeneration == generation) {
+#if _DEBUG
+			auto form = RE::TESForm::LookupByID<T>(_loadedFormID);
+			if (form != _form) {
+				_ERROR("Cached form (%08X) is out of date!", _loadedFormID);
+				_form = form;
+			}
+#endif
+			return _form;
+		}
+
 		if (_loadedFormID == kInvalid) {
 			auto dataHandler = RE::TESDataHandler::GetSingleton();
 			auto modInfo = dataHandler->LookupLoadedModByName(_pluginName.c_str());
@@ -47,13 +66,17 @@ public:
 			}
 		}
 
-		return RE::TESForm::LookupByID<T>(_loadedFormID);
+		_form = RE::TESForm::LookupByID<T>(_loadedFormID);
+		_cacheGeneration = generation;
+		return _form;
 	}
 
 private:
 	UInt32		_rawFormID;
 	UInt32		_loadedFormID;
 	std::string	_pluginName;
+	T*			_form;
+	UInt32		_cacheGeneration;
 };
 
 
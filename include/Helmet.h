@@ -2,8 +2,10 @@
 
 #include "skse64/gamethreads.h"  // TaskDelegate
 
-#include "ISerializableForm.h"  // ISerializableForm
-#include "PlayerUtil.h"  // InventoryChangesVisitor
+#include "EquipSlotManager.h"  // EquipSlotManager, SlotPolicy
+#include "ISerializableForm.h"  // ISerializableForm, SlotRecord
+#include "ItemFingerprint.h"  // ItemFingerprint
+#include "PlayerUtil.h"  // InventoryChangesVisitor, InventoryEntryView
 
 #include "RE/Skyrim.h"
 
@@ -16,25 +18,20 @@ namespace Helmet
 		static Helmet* GetSingleton();
 
 		void Clear();
-		bool Save(SKSE::SerializationInterface* a_intfc, UInt32 a_type, UInt32 a_version);
-		bool Load(SKSE::SerializationInterface* a_intfc);
+		void Save(SlotRecord& a_record);
+		void Load(const SlotRecord& a_record);
 		RE::TESObjectARMO* GetForm();
-		void SetEnchantmentForm(UInt32 a_formID);
-		RE::EnchantmentItem* GetEnchantmentForm();
 		UInt32 GetEnchantmentFormID();
+		void SetInstance(const ItemFingerprint& a_instance);
+		bool Matches(const ItemFingerprint& a_instance);
+		bool MatchesIgnoringHealth(const ItemFingerprint& a_instance);
 
 	protected:
-		class Enchantment : public ISerializableForm
-		{
-		public:
-			Enchantment() = default;
-			~Enchantment() = default;
-
-			RE::EnchantmentItem* GetForm();
-		};
+		// Records saved before tempering was remembered match any health
+		static constexpr float kAnyHealth = 0.0F;
 
 
-		Helmet() = default;
+		Helmet();
 		Helmet(const Helmet&) = delete;
 		Helmet(Helmet&&) = delete;
 		~Helmet() = default;
@@ -43,35 +40,8 @@ namespace Helmet
 		Helmet& operator=(Helmet&&) = delete;
 
 
-		Enchantment _enchantment;
-	};
-
-
-	class HelmetTaskDelegate : public TaskDelegate
-	{
-	public:
-		class HelmetEquipVisitor : public InventoryChangesVisitor
-		{
-		public:
-			virtual bool Accept(RE::InventoryEntryData* a_entry, SInt32 a_count) override;
-		};
-
-
-		class HelmetUnEquipVisitor : public InventoryChangesVisitor
-		{
-		public:
-			virtual bool Accept(RE::InventoryEntryData* a_entry, SInt32 a_count) override;
-		};
-
-
-		explicit HelmetTaskDelegate(bool a_equip);
-		~HelmetTaskDelegate() = default;
-
-		virtual void Run() override;
-		virtual void Dispose() override;
-
-	private:
-		bool _equip;
+		ISerializableForm _enchantment;
+		float _health;
 	};
 
 
@@ -84,7 +54,7 @@ namespace Helmet
 			explicit Visitor(UInt32 a_formID);
 			virtual ~Visitor() = default;
 
-			virtual bool Accept(RE::InventoryEntryData* a_entry, SInt32 a_count) override;
+			virtual bool Accept(InventoryEntryView* a_entry, SInt32 a_count) override;
 
 		private:
 			UInt32 _formID;
@@ -102,48 +72,24 @@ namespace Helmet
 	};
 
 
-	class AnimGraphSinkDelegate : public TaskDelegate
+	// Remembers the worn light/heavy helmet instance and swaps it with the weapon state
+	struct HelmetPolicy : SlotPolicy
 	{
-	public:
-		virtual void Run() override;
-		virtual void Dispose() override;
+		using Data = Helmet;
+		using FirstPersonFlag = RE::BIPED_MODEL::BipedObjectSlot;
+
+		static constexpr auto kName = "helmet";
+		static constexpr UInt32 kRecordType = 'HELM';
+		static constexpr auto kSlots = static_cast<FirstPersonFlag>(static_cast<UInt32>(FirstPersonFlag::kHead) | static_cast<UInt32>(FirstPersonFlag::kHair) | static_cast<UInt32>(FirstPersonFlag::kCirclet));
+		static constexpr auto kUnEquipSlot = FirstPersonFlag::kHair;
+
+		static bool Enabled();
+		static bool IsRemembered(InventoryEntryView* a_entry, SInt32 a_count, RE::ExtraDataList*& a_xList);
+		static bool IsRememberedInstance(const ItemFingerprint& a_instance);
+		static bool IsManagedArmor(RE::TESObjectARMO* a_armor);
+		static void OnEquip(RE::TESObjectARMO* a_armor, bool a_equipped);
 	};
 
 
-	class TESEquipEventHandler : public RE::BSTEventSink<RE::TESEquipEvent>
-	{
-	public:
-		using EventResult = RE::BSEventNotifyControl;
-
-		static TESEquipEventHandler* GetSingleton();
-		virtual EventResult ProcessEvent(const RE::TESEquipEvent* a_event, RE::BSTEventSource<RE::TESEquipEvent>* a_eventSource) override;
-
-	protected:
-		TESEquipEventHandler() = default;
-		TESEquipEventHandler(const TESEquipEventHandler&) = delete;
-		TESEquipEventHandler(TESEquipEventHandler&&) = delete;
-		virtual ~TESEquipEventHandler() = default;
-
-		TESEquipEventHandler& operator=(const TESEquipEventHandler&) = delete;
-		TESEquipEventHandler& operator=(TESEquipEventHandler&&) = delete;
-	};
-
-
-	class BSAnimationGraphEventHandler : public RE::BSTEventSink<RE::BSAnimationGraphEvent>
-	{
-	public:
-		using EventResult = RE::BSEventNotifyControl;
-
-		static BSAnimationGraphEventHandler* GetSingleton();
-		virtual EventResult ProcessEvent(const RE::BSAnimationGraphEvent* a_event, RE::BSTEventSource<RE::BSAnimationGraphEvent>* a_eventSource) override;
-
-	protected:
-		BSAnimationGraphEventHandler() = default;
-		BSAnimationGraphEventHandler(const BSAnimationGraphEventHandler&) = delete;
-		BSAnimationGraphEventHandler(BSAnimationGraphEventHandler&&) = delete;
-		virtual ~BSAnimationGraphEventHandler() = default;
-
-		BSAnimationGraphEventHandler& operator=(const BSAnimationGraphEventHandler&) = delete;
-		BSAnimationGraphEventHandler& operator=(BSAnimationGraphEventHandler&&) = delete;
-	};
+	using Manager = EquipSlotManager<HelmetPolicy>;
 }
@@ -4,7 +4,6 @@
 #undef GetForm
 
 #include "RE/Skyrim.h"
-#include "SKSE/Interfaces.h"
 
 
 enum : UInt32
@@ -13,6 +12,18 @@ enum : UInt32
 };
 
 
+// One fixed-layout entry of the co-save record, tagged with the type code of the slot it belongs to
+// Form IDs are resolved by the loader before an entry reaches its owner
+struct SlotRecord
+{
+	UInt32 type;
+	UInt32 formID;
+	UInt32 enchantment;
+	float health;
+};
+static_assert(sizeof(SlotRecord) == 16);
+
+
 class ISerializableForm
 {
 public:
@@ -25,13 +36,14 @@ public:
 	ISerializableForm& operator=(ISerializableForm&&) = default;
 
 	void Clear();
-	bool Save(SKSE::SerializationInterface* a_intfc, UInt32 a_type, UInt32 a_version);
-	bool Save(SKSE::SerializationInterface* a_intfc);
-	bool Load(SKSE::SerializationInterface* a_intfc);
+	void Save(SlotRecord& a_record);
+	void Load(const SlotRecord& a_record);
 	void SetForm(UInt32 a_formID);
 	RE::TESForm* GetForm();
 	UInt32 GetFormID();
 
 protected:
 	UInt32 _formID;
+	RE::TESForm* _form;
+	UInt32 _cacheGeneration;
 };
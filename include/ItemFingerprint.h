@@ -0,0 +1,26 @@
+#pragma once
+
+#include "PlayerUtil.h"  // FormID
+
+#include "RE/Skyrim.h"
+
+
+// Identifies one instance of an item: its base form plus the extra data that sets copies apart
+// Two instances with the same fingerprint are interchangeable for equipping
+struct ItemFingerprint
+{
+	static constexpr float kUntempered = 1.0F;
+
+
+	ItemFingerprint();
+	ItemFingerprint(FormID a_formID, FormID a_enchantment, float a_health);
+	ItemFingerprint(RE::TESBoundObject* a_object, RE::ExtraDataList* a_xList);
+
+	bool operator==(const ItemFingerprint& a_rhs) const;
+	bool operator!=(const ItemFingerprint& a_rhs) const;
+
+
+	FormID formID;
+	FormID enchantment;
+	float health;
+};
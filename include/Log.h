@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>  // size_t
+
+#include "SKSE/Logger.h"  // Logger
+
+
+// Messages above this level are compiled out, builds may override it with a preprocessor definition
+// 0 = fatal error, 1 = error, 2 = warning, 3 = message, 4 = verbose message, 5 = debug message
+#ifndef DNEM_LOG_LEVEL
+#if _DEBUG
+#define DNEM_LOG_LEVEL 5
+#else
+#define DNEM_LOG_LEVEL 3
+#endif
+#endif
+
+
+namespace Log
+{
+	using Level = SKSE::Logger::Level;
+
+
+	constexpr Level kCompiledLevel = static_cast<Level>(DNEM_LOG_LEVEL);
+	static_assert(kCompiledLevel >= Level::kFatalError && kCompiledLevel <= Level::kDebugMessage);
+
+
+	constexpr bool IsCompiled(Level a_level)
+	{
+		return a_level <= kCompiledLevel;
+	}
+
+
+	// Messages are written synchronously until the writer thread is started
+	// After that they are formatted and timestamped into a bounded lock-free ring on the logging thread, and a background writer drains
+	// the ring in batches with one flush per batch, so logging never waits on the disk
+	// Messages logged while the ring is full are dropped and counted
+	bool Open(const KNOWNFOLDERID& a_id, const wchar_t* a_relativePath);
+	void SetPrintLevel(Level a_level);
+	void StartWriter();
+	void Print(Level a_level, const char* a_format, ...);
+	std::size_t GetDroppedCount();
+}
+
+
+#undef _FATALERROR
+#undef _ERROR
+#undef _WARNING
+#undef _MESSAGE
+#undef _VMESSAGE
+#undef _DMESSAGE
+
+// Arguments are still type checked in compiled out messages, but no call or format string is emitted
+#define DNEM_LOG(a_level, ...)						\
+	do {											\
+		if constexpr (Log::IsCompiled(a_level)) {	\
+			Log::Print(a_level, __VA_ARGS__);		\
+		}											\
+	} while (false)
+
+#define _FATALERROR(...) DNEM_LOG(Log::Level::kFatalError, __VA_ARGS__)
+#define _ERROR(...) DNEM_LOG(Log::Level::kError, __VA_ARGS__)
+#define _WARNING(...) DNEM_LOG(Log::Level::kWarning, __VA_ARGS__)
+#define _MESSAGE(...) DNEM_LOG(Log::Level::kMessage, __VA_ARGS__)
+#define _VMESSAGE(...) DNEM_LOG(Log::Level::kVerboseMessage, __VA_ARGS__)
+#define _DMESSAGE(...) DNEM_LOG(Log::Level::kDebugMessage, __VA_ARGS__)
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "EquipSlotManager.h"  // EquipSlotTable
+#include "Helmet.h"  // Helmet::Manager
+#include "Shield.h"  // Shield::Manager
+
+
+// Every armor slot managed by the plugin
+// A new slot only needs its policy and an entry here
+using ManagedSlots = EquipSlotTable<Helmet::Manager, Shield::Manager>;
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "skse64/gamethreads.h"  // TaskDelegate
+
+#include <atomic>  // atomic
+#include <mutex>  // mutex
+
+#include "RE/Skyrim.h"
+
+
+namespace Menu
+{
+	// Coalesces item list rebuilds of the open InventoryMenu
+	// Any number of requests made during a frame result in a single Update, run at the end of the frame's task queue
+	// The menu pointer is held only while the menu is open
+	class InventoryMenuRefresh
+	{
+	public:
+		static InventoryMenuRefresh* GetSingleton();
+
+		void Request();
+		void Run();
+		void OnOpen();
+		void OnClose();
+
+	protected:
+		InventoryMenuRefresh();
+		InventoryMenuRefresh(const InventoryMenuRefresh&) = delete;
+		InventoryMenuRefresh(InventoryMenuRefresh&&) = delete;
+		~InventoryMenuRefresh() = default;
+
+		InventoryMenuRefresh& operator=(const InventoryMenuRefresh&) = delete;
+		InventoryMenuRefresh& operator=(InventoryMenuRefresh&&) = delete;
+
+
+		std::mutex _menuLock;
+		RE::GPtr<RE::InventoryMenu> _menu;
+		std::atomic<bool> _open;
+		std::atomic<bool> _pending;
+	};
+
+
+	class InventoryMenuRefreshDelegate : public TaskDelegate
+	{
+	public:
+		virtual void Run() override;
+		virtual void Dispose() override;
+	};
+
+
+	class MenuOpenCloseEventHandler : public RE::BSTEventSink<RE::MenuOpenCloseEvent>
+	{
+	public:
+		using EventResult = RE::BSEventNotifyControl;
+
+		static MenuOpenCloseEventHandler* GetSingleton();
+		virtual EventResult ProcessEvent(const RE::MenuOpenCloseEvent* a_event, RE::BSTEventSource<RE::MenuOpenCloseEvent>* a_eventSource) override;
+
+	protected:
+		MenuOpenCloseEventHandler() = default;
+		MenuOpenCloseEventHandler(const MenuOpenCloseEventHandler&) = delete;
+		MenuOpenCloseEventHandler(MenuOpenCloseEventHandler&&) = delete;
+		virtual ~MenuOpenCloseEventHandler() = default;
+
+		MenuOpenCloseEventHandler& operator=(const MenuOpenCloseEventHandler&) = delete;
+		MenuOpenCloseEventHandler& operator=(MenuOpenCloseEventHandler&&) = delete;
+	};
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>  // atomic
+#include <chrono>  // steady_clock
+#include <cstddef>  // size_t
+
+#include "RE/Skyrim.h"
+
+
+namespace Metrics
+{
+	enum class Metric : std::size_t
+	{
+		kAnimationEvent,
+		kEquipEvent,
+		kObjectLoadedEvent,
+		kContainerChangedEvent,
+		kSwitchRaceEvent,
+		kMenuOpenCloseEvent,
+		kInventoryTaskBatch,
+		kDelayedWeaponTask,
+		kDelayedAmmoTask,
+		kDelayedHelmetLocator,
+		kAnimGraphSinkTask,
+		kMenuRefreshTask,
+		kInventoryVisit,
+		kSchedulerPump,
+
+		kTotal
+	};
+
+
+	enum : std::size_t
+	{
+		kNumBuckets = 40,	// bucket i holds latencies in [2^i, 2^(i+1)) ns
+		kMaxThreads = 64
+	};
+
+
+	// Counters and a log2 latency histogram for every metric, owned by one thread
+	// Only the owning thread writes, so relaxed atomics are enough and no update ever locks
+	struct ThreadBlock
+	{
+		struct Histogram
+		{
+			std::atomic<UInt64> count;
+			std::atomic<UInt64> totalNanoseconds;
+			std::atomic<UInt64> buckets[kNumBuckets];
+		};
+
+
+		Histogram histograms[static_cast<std::size_t>(Metric::kTotal)];
+	};
+
+
+	void Add(Metric a_metric, UInt64 a_nanoseconds);
+	void Dump();
+	void StartPeriodicDump(void (*a_dump)());
+
+
+	// Times the enclosing scope into a metric
+	class ScopedTimer
+	{
+	public:
+		explicit ScopedTimer(Metric a_metric);
+		~ScopedTimer();
+
+		ScopedTimer(const ScopedTimer&) = delete;
+		ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+	private:
+		Metric _metric;
+		std::chrono::steady_clock::time_point _start;
+	};
+}
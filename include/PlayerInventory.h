@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>  // atomic
+#include <mutex>  // mutex
+#include <unordered_map>  // unordered_map
+#include <vector>  // vector
+
+#include "PlayerUtil.h"  // InventoryChangesVisitor, InventoryEntryView, FormID, Count
+
+#include "RE/Skyrim.h"
+
+
+namespace Inventory
+{
+	// Shadow copy of the player's merged inventory (InventoryChanges + base TESContainer)
+	// Kept up to date from container change events so visits never have to rebuild it
+	// Stored as a flat vector sorted by formID, whose capacity is reused across rebuilds
+	// Extra lists belong to the engine, so each entry keeps its live changes entry and reads the extra lists from it only when visited
+	// Equip events invalidate their form, since the engine adds a changes entry without a container change event when a base item is equipped
+	class PlayerInventory
+	{
+	public:
+		static PlayerInventory* GetSingleton();
+
+		void Visit(InventoryChangesVisitor* a_visitor);
+		void Invalidate();
+		void Invalidate(FormID a_formID);
+
+	protected:
+		struct Entry
+		{
+			FormID formID;
+			InventoryEntryView view;
+			Count count;
+			RE::InventoryEntryData* changes;
+		};
+
+
+		using Index = std::vector<Entry>;
+
+
+		enum : std::size_t { kMaxPending = 32 };
+
+
+		PlayerInventory();
+		PlayerInventory(const PlayerInventory&) = delete;
+		PlayerInventory(PlayerInventory&&) = delete;
+		~PlayerInventory() = default;
+
+		PlayerInventory& operator=(const PlayerInventory&) = delete;
+		PlayerInventory& operator=(PlayerInventory&&) = delete;
+
+		void Sync();
+		void Rebuild();
+		void Refresh();
+		Index::iterator Find(FormID a_formID);
+
+
+		std::mutex _indexLock;
+		Index _index;
+		RE::InventoryChanges* _changes;
+		UInt32 _syncedGeneration;
+		std::vector<FormID> _work;
+		std::vector<Entry> _refreshed;
+
+		std::mutex _pendingLock;
+		std::vector<FormID> _pending;
+		bool _rebuild;
+		std::atomic<UInt32> _generation;
+	};
+
+
+	// Per-ammo counts of the player's inventory, kept current from container change deltas
+	// Rebuilt from one full scan after an invalidation, so a lookup never walks the inventory
+	// Debug builds cross-check every lookup against a full scan
+	class AmmoCounts
+	{
+	public:
+		static AmmoCounts* GetSingleton();
+
+		Count GetCount(FormID a_formID);
+		void Apply(FormID a_formID, Count a_delta);
+		void Invalidate();
+
+	protected:
+		class Visitor : public InventoryChangesVisitor
+		{
+		public:
+			explicit Visitor(std::unordered_map<FormID, Count>& a_counts);
+			virtual ~Visitor() = default;
+
+			virtual bool Accept(InventoryEntryView* a_entry, SInt32 a_count) override;
+
+		private:
+			std::unordered_map<FormID, Count>& _counts;
+		};
+
+
+		AmmoCounts();
+		AmmoCounts(const AmmoCounts&) = delete;
+		AmmoCounts(AmmoCounts&&) = delete;
+		~AmmoCounts() = default;
+
+		AmmoCounts& operator=(const AmmoCounts&) = delete;
+		AmmoCounts& operator=(AmmoCounts&&) = delete;
+
+		void Rebuild();
+#if _DEBUG
+		void Validate();
+#endif
+
+
+		std::mutex _lock;
+		std::unordered_map<FormID, Count> _counts;
+		bool _rebuild;
+	};
+
+
+	class TESContainerChangedEventHandler : public RE::BSTEventSink<RE::TESContainerChangedEvent>
+	{
+	public:
+		using EventResult = RE::BSEventNotifyControl;
+
+		static TESContainerChangedEventHandler* GetSingleton();
+		virtual EventResult ProcessEvent(const RE::TESContainerChangedEvent* a_event, RE::BSTEventSource<RE::TESContainerChangedEvent>* a_eventSource) override;
+
+	protected:
+		TESContainerChangedEventHandler() = default;
+		TESContainerChangedEventHandler(const TESContainerChangedEventHandler&) = delete;
+		TESContainerChangedEventHandler(TESContainerChangedEventHandler&&) = delete;
+		virtual ~TESContainerChangedEventHandler() = default;
+
+		TESContainerChangedEventHandler& operator=(const TESContainerChangedEventHandler&) = delete;
+		TESContainerChangedEventHandler& operator=(TESContainerChangedEventHandler&&) = delete;
+	};
+}
@@ -1,7 +1,11 @@
 #pragma once
 
+#include "skse64/gamethreads.h"  // TaskDelegate
 #include "skse64/PluginAPI.h"  // SKSETaskInterface
 
+#include <array>  // array
+#include <atomic>  // atomic
+
 #include "RE/Skyrim.h"
 
 
@@ -12,16 +16,92 @@ namespace
 }
 
 
+// Lightweight view of a merged inventory entry
+// Items only present in the base container have no extra data
+struct InventoryEntryView
+{
+	RE::TESBoundObject* object;
+	RE::BSSimpleList<RE::ExtraDataList*>* extraLists;
+};
+
+
 class InventoryChangesVisitor
 {
 public:
 	InventoryChangesVisitor() = default;
 	virtual ~InventoryChangesVisitor() = default;
 
-	virtual bool Accept(RE::InventoryEntryData* a_entry, SInt32 a_count) = 0;
+	virtual bool Accept(InventoryEntryView* a_entry, SInt32 a_count) = 0;
+};
+
+
+// Feeds several visitors from one walk, dropping each visitor once its Accept returns false
+class CompositeInventoryChangesVisitor : public InventoryChangesVisitor
+{
+public:
+	enum : std::size_t { kCapacity = 16 };
+
+
+	CompositeInventoryChangesVisitor();
+	virtual ~CompositeInventoryChangesVisitor() = default;
+
+	virtual bool Accept(InventoryEntryView* a_entry, SInt32 a_count) override;
+	bool Add(InventoryChangesVisitor* a_visitor);
+	void Clear();
+	bool Empty() const;
+	bool Full() const;
+
+private:
+	std::array<InventoryChangesVisitor*, kCapacity> _visitors;
+	std::size_t _size;
+};
+
+
+// A task whose work is an unequip pass followed by a single inventory visit
+// Tasks queued through QueueInventoryTask within the same frame share one walk, which visits entries in formID order
+// Every task's unequip pass runs before that walk, so a batch applies all of its unequips before any of its equips
+class InventoryTaskDelegate : public TaskDelegate
+{
+public:
+	virtual void Run() override;
+
+	virtual void UnEquip();
+	virtual InventoryChangesVisitor* Prepare() = 0;
+	virtual void Finish();
+};
+
+
+// Latest desired equip state for a managed slot
+// Sinks post into it and only queue a task when nothing was pending, the task then takes whatever is latest
+// Intents overwritten before their task ran are counted as dropped
+class EquipIntent
+{
+public:
+	enum class State : UInt32
+	{
+		kNone,
+		kEquip,
+		kUnEquip
+	};
+
+
+	EquipIntent();
+
+	bool Post(bool a_equip);
+	State Take();
+	std::size_t GetDroppedCount() const;
+
+private:
+	std::atomic<State> _state;
+	std::atomic<std::size_t> _dropped;
 };
 
 
 void VisitPlayerInventoryChanges(InventoryChangesVisitor* a_visitor);
+void QueueInventoryTask(InventoryTaskDelegate* a_task);
+std::size_t GetInventoryTaskOverflowCount();
+void EquipPlayerItem(RE::TESBoundObject* a_item, RE::ExtraDataList* a_xList, UInt32 a_count, RE::BGSEquipSlot* a_slot);
+void UnEquipPlayerItem(RE::TESBoundObject* a_item, RE::ExtraDataList* a_xList, UInt32 a_count, RE::BGSEquipSlot* a_slot);
 bool SinkAnimationGraphEventHandler(RE::BSTEventSink<RE::BSAnimationGraphEvent>* a_sink);
 bool PlayerIsBeastRace();
+void UpdatePlayerBeastRace();
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "skse64/gamethreads.h"  // TaskDelegate
+
+#include <cstddef>  // size_t
+
+
+namespace Scheduler
+{
+	enum class Priority : std::size_t
+	{
+		kEquip,			// equip changes the player sees, always run in the frame they were queued for
+		kInterface,		// menu updates, run after every equip change of the frame
+		kBookkeeping,	// state tracking, run while the frame budget lasts and deferred to the next frame after that
+
+		kTotal
+	};
+
+
+	// Hooks the player's per-frame update, which hands deferred bookkeeping back to the task loop
+	void InstallHooks();
+
+	// Queues a plugin task behind a single SKSE task per frame
+	void AddTask(TaskDelegate* a_task, Priority a_priority);
+	std::size_t GetDeferredCount();
+	std::size_t GetPumpOverflowCount();
+}
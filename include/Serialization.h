@@ -0,0 +1,21 @@
+#pragma once
+
+#include <vector>  // vector
+
+#include "ISerializableForm.h"  // SlotRecord
+
+#include "SKSE/Interfaces.h"
+
+
+namespace Serialization
+{
+	// Every remembered item goes into a single versioned record: a fixed header followed by one SlotRecord per remembered slot
+	// Loading reads the record in bulk, resolves all form IDs in one pass, then hands each entry to the slot that owns its type code
+	// Records from older versions are migrated into the same entries instead of being discarded
+	bool Save(SKSE::SerializationInterface* a_intfc);
+	void Load(SKSE::SerializationInterface* a_intfc);
+
+	// Copies the remembered items out of their slots and back, without going through a co-save
+	void Snapshot(std::vector<SlotRecord>& a_records);
+	void Restore(const std::vector<SlotRecord>& a_records);
+}
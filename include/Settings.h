@@ -14,6 +14,9 @@ public:
 	static bSetting	manageAmmo;
 	static bSetting	manageHelmet;
 	static bSetting	manageShield;
+	static bSetting	recordEventTrace;
+	static bSetting	replayEventTrace;
+	static iSetting	taskBudget;
 
 private:
 	static constexpr char FILE_NAME[] = "Data\\SKSE\\Plugins\\DynamicEquipmentManagerSSE.json";
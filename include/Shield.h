@@ -1,9 +1,9 @@
 #pragma once
 
-#include "skse64/gamethreads.h"  // TaskDelegate
-
+#include "EquipSlotManager.h"  // EquipSlotManager, SlotPolicy
 #include "ISerializableForm.h"  // ISerializableForm
-#include "PlayerUtil.h"  // InventoryChangesVisitor
+#include "ItemFingerprint.h"  // ItemFingerprint
+#include "PlayerUtil.h"  // InventoryEntryView
 
 #include "RE/Skyrim.h"
 
@@ -28,85 +28,30 @@ namespace Shield
 	};
 
 
-	class ShieldTaskDelegate : public TaskDelegate
-	{
-	public:
-		class ShieldEquipVisitor : public InventoryChangesVisitor
-		{
-		public:
-			virtual bool Accept(RE::InventoryEntryData* a_entry, SInt32 a_count) override;
-		};
-
-
-		class ShieldUnEquipVisitor : public InventoryChangesVisitor
-		{
-		public:
-			virtual bool Accept(RE::InventoryEntryData* a_entry, SInt32 a_count) override;
-		};
-
-
-		ShieldTaskDelegate(bool a_equip);
-		virtual ~ShieldTaskDelegate() = default;
-
-		virtual void Run() override;
-		virtual void Dispose() override;
-
-	private:
-		bool _equip;
-	};
-
-
-	class AnimGraphSinkDelegate : public TaskDelegate
-	{
-	public:
-		virtual void Run() override;
-		virtual void Dispose() override;
-	};
-
-
-	class TESEquipEventHandler : public RE::BSTEventSink<RE::TESEquipEvent>
+	// Remembers the equipped shield and swaps it with the weapon state, as long as the left hand is free
+	struct ShieldPolicy : SlotPolicy
 	{
-	public:
-		using EventResult = RE::BSEventNotifyControl;
-
-		static TESEquipEventHandler* GetSingleton();
-		virtual EventResult ProcessEvent(const RE::TESEquipEvent* a_event, RE::BSTEventSource<RE::TESEquipEvent>* a_eventSource) override;
-
-	protected:
-		TESEquipEventHandler() = default;
-		TESEquipEventHandler(const TESEquipEventHandler&) = delete;
-		TESEquipEventHandler(TESEquipEventHandler&&) = delete;
-		virtual ~TESEquipEventHandler() = default;
-
-		TESEquipEventHandler& operator=(const TESEquipEventHandler&) = delete;
-		TESEquipEventHandler& operator=(TESEquipEventHandler&&) = delete;
+		using Data = Shield;
+		using FirstPersonFlag = RE::BIPED_MODEL::BipedObjectSlot;
+
+		static constexpr auto kName = "shield";
+		static constexpr UInt32 kRecordType = 'SHLD';
+		static constexpr auto kSlots = FirstPersonFlag::kShield;
+		static constexpr auto kUnEquipSlot = FirstPersonFlag::kShield;
+
+		static bool Enabled();
+		static bool CanEquip();
+		static void OnBeforeEquip();
+		static void OnTailCombatIdle();
+		static bool IsRemembered(InventoryEntryView* a_entry, SInt32 a_count, RE::ExtraDataList*& a_xList);
+		static bool IsRememberedInstance(const ItemFingerprint& a_instance);
+		static bool IsManagedArmor(RE::TESObjectARMO* a_armor);
+		static void OnEquip(RE::TESObjectARMO* a_armor, bool a_equipped);
 	};
 
 
-	class BSAnimationGraphEventHandler : public RE::BSTEventSink<RE::BSAnimationGraphEvent>
-	{
-	public:
-		using EventResult = RE::BSEventNotifyControl;
-
-		static BSAnimationGraphEventHandler* GetSingleton();
-		virtual EventResult ProcessEvent(const RE::BSAnimationGraphEvent* a_event, RE::BSTEventSource<RE::BSAnimationGraphEvent>* a_eventSource) override;
-
-	protected:
-		BSAnimationGraphEventHandler() = default;
-		BSAnimationGraphEventHandler(const BSAnimationGraphEventHandler&) = delete;
-		BSAnimationGraphEventHandler(BSAnimationGraphEventHandler&&) = delete;
-		virtual ~BSAnimationGraphEventHandler() = default;
-
-		BSAnimationGraphEventHandler& operator=(const BSAnimationGraphEventHandler&) = delete;
-		BSAnimationGraphEventHandler& operator=(BSAnimationGraphEventHandler&&) = delete;
-	};
+	using Manager = EquipSlotManager<ShieldPolicy>;
 
 
 	void InstallHooks();
-
-
-	namespace
-	{
-		bool g_skipAnim = false;
-	}
 }
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>  // atomic
+#include <cstddef>  // size_t
+#include <cstdint>  // uintptr_t
+#include <new>  // placement new
+#include <type_traits>  // aligned_storage_t
+#include <utility>  // forward
+
+
+// Fixed-capacity slab for task delegates, recycled from Dispose through Release
+// Slots are claimed with a CAS so tasks can be created on any thread and released on another
+// Falls back to the heap once every slot is in use, and counts how often that happens
+template <class T, std::size_t N = 16>
+class TaskPool
+{
+public:
+	TaskPool() = delete;
+
+
+	template <class... Args>
+	static T* Create(Args&&... a_args)
+	{
+		for (std::size_t i = 0; i < N; ++i) {
+			bool expected = false;
+			if (!_inUse[i].load(std::memory_order_relaxed) && _inUse[i].compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+				return new(&_slots[i]) T(std::forward<Args>(a_args)...);
+			}
+		}
+
+		++_overflows;
+		return new T(std::forward<Args>(a_args)...);
+	}
+
+
+	static void Release(T* a_task)
+	{
+		auto addr = reinterpret_cast<std::uintptr_t>(a_task);
+		auto begin = reinterpret_cast<std::uintptr_t>(_slots);
+		auto end = reinterpret_cast<std::uintptr_t>(_slots + N);
+		if (addr >= begin && addr < end) {
+			a_task->~T();
+			_inUse[(addr - begin) / sizeof(Slot)].store(false, std::memory_order_release);
+		} else {
+			delete a_task;
+		}
+	}
+
+
+	static std::size_t GetOverflowCount()
+	{
+		return _overflows;
+	}
+
+private:
+	using Slot = std::aligned_storage_t<sizeof(T), alignof(T)>;
+
+
+	static inline Slot _slots[N];
+	static inline std::atomic<bool> _inUse[N];
+	static inline std::atomic<std::size_t> _overflows = 0;
+};
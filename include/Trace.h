@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>  // size_t
+
+#include "RE/Skyrim.h"
+
+
+namespace Trace
+{
+	enum class Kind : UInt8
+	{
+		kAnimation,
+		kEquip,
+		kObjectLoaded,
+		kSwitchRace
+	};
+
+
+	enum Flag : UInt8
+	{
+		kNone = 0,
+		kPlayer = 1 << 0,	// the event came from the player, so the sinks dispatched it
+		kEquipped = 1 << 1
+	};
+
+
+	// One fixed-size trace record
+	// The timestamp is in microseconds since recording started, the payload is an Anim hash or a formID, the flags are a Flag mask
+	struct Entry
+	{
+		UInt64 timestamp;
+		UInt64 payload;
+		Kind kind;
+		UInt8 flags;
+		UInt8 pad[6];
+	};
+	static_assert(sizeof(Entry) == 24);
+
+
+	// Recording captures every event the plugin's sinks receive, before they filter out other actors
+	// The trace stays open for the whole session and is flushed on every save
+	// Replay waits out the recorded timing on a background thread and hands each event to the game thread, which runs the same dispatch functions for the player's events
+	// While replaying, equip calls into the game and worn slot updates are skipped, and the remembered items and inventory caches are restored once the last event ran
+	// Form IDs are stored as loaded, so a trace only replays faithfully under the load order it was recorded with
+	bool StartRecording(const char* a_path);
+	void Flush();
+	bool IsRecording();
+	void Record(Kind a_kind, UInt64 a_payload, bool a_player, bool a_equipped = false);
+	bool Replay(const char* a_path);
+	bool IsReplaying();
+	std::size_t GetReplayOverflowCount();
+}
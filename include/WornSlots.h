@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>  // array
+#include <mutex>  // mutex
+
+#include "PlayerUtil.h"  // InventoryChangesVisitor, InventoryEntryView, FormID
+
+#include "RE/Skyrim.h"
+
+
+namespace Inventory
+{
+	// Which armor occupies each of the player's 32 biped slots, kInvalid when the slot is empty
+	// Kept current from equip events, rebuilt from one scan of worn items after an invalidation
+	class WornSlots
+	{
+	public:
+		using Slot = RE::BIPED_MODEL::BipedObjectSlot;
+
+
+		static WornSlots* GetSingleton();
+
+		FormID GetItem(Slot a_slot);
+		bool IsWorn(FormID a_formID);
+		RE::ExtraDataList* GetExtraList(FormID a_formID);
+		void Update(RE::TESObjectARMO* a_armor, bool a_equipped);
+		void Invalidate();
+
+	protected:
+		enum : std::size_t { kNumSlots = 32 };
+
+
+		using Items = std::array<FormID, kNumSlots>;
+
+
+		class Visitor : public InventoryChangesVisitor
+		{
+		public:
+			explicit Visitor(Items& a_items);
+			virtual ~Visitor() = default;
+
+			virtual bool Accept(InventoryEntryView* a_entry, SInt32 a_count) override;
+
+		private:
+			Items& _items;
+		};
+
+
+		WornSlots();
+		WornSlots(const WornSlots&) = delete;
+		WornSlots(WornSlots&&) = delete;
+		~WornSlots() = default;
+
+		WornSlots& operator=(const WornSlots&) = delete;
+		WornSlots& operator=(WornSlots&&) = delete;
+
+		void Sync();
+		static void Set(Items& a_items, UInt32 a_slots, FormID a_formID);
+
+
+		std::mutex _lock;
+		Items _items;
+		bool _rebuild;
+	};
+}
@@ -1,14 +1,26 @@
 #include "Ammo.h"
 
 #include "Forms.h"  // WeapTypeBoundArrow
-#include "PlayerUtil.h"  // PlayerIsBeastRace
+#include "MenuRefresh.h"  // InventoryMenuRefresh
+#include "Metrics.h"  // ScopedTimer, Metric
+#include "PlayerInventory.h"  // AmmoCounts
+#include "PlayerUtil.h"  // VisitPlayerInventoryChanges, EquipPlayerItem, UnEquipPlayerItem
+#include "Scheduler.h"  // AddTask, Priority
+#include "Settings.h"  // Settings
+#include "TaskPool.h"  // TaskPool
 
-#include "SKSE/API.h"
 #include "RE/Skyrim.h"
 
 
 namespace Ammo
 {
+	namespace
+	{
+		FormMailbox g_equippedAmmo;
+		FormMailbox g_equippedWeapon;
+	}
+
+
 	Ammo* Ammo::GetSingleton()
 	{
 		static Ammo singleton;
@@ -22,83 +34,88 @@ namespace Ammo
 	}
 
 
-	void DelayedWeaponTaskDelegate::Run()
+	FormMailbox::FormMailbox() :
+		_slot(Pack(kInvalid, 0))
+	{}
+
+
+	void FormMailbox::Post(UInt32 a_formID)
 	{
-		if (g_equippedWeaponFormID != kInvalid) {
-			auto weap = RE::TESForm::LookupByID<RE::TESObjectWEAP>(g_equippedWeaponFormID);
+		auto slot = _slot.load();
+		while (!_slot.compare_exchange_weak(slot, Pack(a_formID, Unpack(slot).sequence + 1))) {}
+	}
 
-			if ((!weap->IsBow() && !weap->IsCrossbow()) || weap->IsBound()) {
-				g_equippedWeaponFormID = kInvalid;
-				return;
-			}
 
-			Visitor visitor;
-			VisitPlayerInventoryChanges(&visitor);
+	auto FormMailbox::Peek() const
+		-> Letter
+	{
+		return Unpack(_slot.load());
+	}
 
-			auto ammo = Ammo::GetSingleton()->GetForm();
-			if (ammo) {
-				auto equipManager = RE::ActorEquipManager::GetSingleton();
-				auto player = RE::PlayerCharacter::GetSingleton();
-				equipManager->EquipItem(player, ammo, 0, visitor.Count(), 0, true, false, false);
-
-				auto ui = RE::UI::GetSingleton();
-				auto intStrings = RE::InterfaceStrings::GetSingleton();
-				auto invMenu = ui->GetMenu<RE::InventoryMenu>(intStrings->inventoryMenu);
-				if (invMenu && invMenu->itemList) {
-					invMenu->itemList->Update(player);
-				}
-			}
 
-			g_equippedWeaponFormID = kInvalid;
-		}
+	bool FormMailbox::Clear(const Letter& a_letter)
+	{
+		auto expected = Pack(a_letter.formID, a_letter.sequence);
+		return _slot.compare_exchange_strong(expected, Pack(kInvalid, a_letter.sequence));
 	}
 
 
-	void DelayedWeaponTaskDelegate::Dispose()
+	UInt64 FormMailbox::Pack(UInt32 a_formID, UInt32 a_sequence)
 	{
-		delete this;
+		return (static_cast<UInt64>(a_sequence) << 32) | a_formID;
 	}
 
 
-	DelayedWeaponTaskDelegate::Visitor::Visitor() :
-		_count(0)
-	{}
+	auto FormMailbox::Unpack(UInt64 a_slot)
+		-> Letter
+	{
+		return { static_cast<UInt32>(a_slot), static_cast<UInt32>(a_slot >> 32) };
+	}
 
 
-	bool DelayedWeaponTaskDelegate::Visitor::Accept(RE::InventoryEntryData* a_entry, SInt32 a_count)
+	void DelayedWeaponTaskDelegate::Run()
 	{
-		if (a_entry->object->IsAmmo()) {
-			if (a_entry->object->formID == Ammo::GetSingleton()->GetFormID()) {
-				_count = a_count;
-				return false;
+		Metrics::ScopedTimer timer(Metrics::Metric::kDelayedWeaponTask);
+
+		auto letter = g_equippedWeapon.Peek();
+		if (letter.formID != kInvalid) {
+			auto weap = RE::TESForm::LookupByID<RE::TESObjectWEAP>(letter.formID);
+
+			if (!weap || (!weap->IsBow() && !weap->IsCrossbow()) || weap->IsBound()) {
+				g_equippedWeapon.Clear(letter);
+				return;
 			}
+
+			auto ammo = Ammo::GetSingleton()->GetForm();
+			if (ammo) {
+				auto count = Inventory::AmmoCounts::GetSingleton()->GetCount(ammo->formID);
+				EquipPlayerItem(ammo, 0, count, 0);
+				Menu::InventoryMenuRefresh::GetSingleton()->Request();
+			}
+
+			g_equippedWeapon.Clear(letter);
 		}
-		return true;
 	}
 
 
-	SInt32 DelayedWeaponTaskDelegate::Visitor::Count() const
+	void DelayedWeaponTaskDelegate::Dispose()
 	{
-		return _count;
+		TaskPool<DelayedWeaponTaskDelegate>::Release(this);
 	}
 
 
-	bool DelayedAmmoTaskDelegate::Visitor::Accept(RE::InventoryEntryData* a_entry, SInt32 a_count)
+	DelayedAmmoTaskDelegate::Visitor::Visitor(UInt32 a_formID) :
+		_formID(a_formID)
+	{}
+
+
+	bool DelayedAmmoTaskDelegate::Visitor::Accept(InventoryEntryView* a_entry, SInt32 a_count)
 	{
-		if (a_entry->object->formID == g_equippedAmmoFormID && a_entry->extraLists) {
+		if (a_entry->object->formID == _formID && a_entry->extraLists) {
 			for (auto& xList : *a_entry->extraLists) {
 				if (xList->HasType(RE::ExtraDataType::kWorn) || xList->HasType(RE::ExtraDataType::kWornLeft)) {
-					auto equipManager = RE::ActorEquipManager::GetSingleton();
-					auto player = RE::PlayerCharacter::GetSingleton();
-					equipManager->UnequipItem(player, a_entry->object, xList, a_count, 0, true, false);
-
-					auto ui = RE::UI::GetSingleton();
-					auto intStrings = RE::InterfaceStrings::GetSingleton();
-					auto invMenu = ui->GetMenu<RE::InventoryMenu>(intStrings->inventoryMenu);
-					if (invMenu && invMenu->itemList) {
-						invMenu->itemList->Update(player);
-					}
-
+					UnEquipPlayerItem(a_entry->object, xList, a_count, 0);
+					Menu::InventoryMenuRefresh::GetSingleton()->Request();
 					return false;
 				}
 			}
@@ -109,78 +126,66 @@ namespace Ammo
 
 	void DelayedAmmoTaskDelegate::Run()
 	{
-		if (g_equippedAmmoFormID != kInvalid) {
-			RE::TESAmmo* ammo = RE::TESForm::LookupByID<RE::TESAmmo>(g_equippedAmmoFormID);
-			if (!ammo->HasKeyword(WeapTypeBoundArrow)) {
-				if (g_equippedWeaponFormID == kInvalid) {
-					Ammo::GetSingleton()->SetForm(g_equippedAmmoFormID);
+		Metrics::ScopedTimer timer(Metrics::Metric::kDelayedAmmoTask);
+
+		auto letter = g_equippedAmmo.Peek();
+		if (letter.formID != kInvalid) {
+			RE::TESAmmo* ammo = RE::TESForm::LookupByID<RE::TESAmmo>(letter.formID);
+			if (ammo && !ammo->HasKeyword(WeapTypeBoundArrow)) {
+				if (g_equippedWeapon.Peek().formID == kInvalid) {
+					Ammo::GetSingleton()->SetForm(letter.formID);
 				} else {
 					// Ammo was force equipped
-					Visitor visitor;
+					Visitor visitor(letter.formID);
 					VisitPlayerInventoryChanges(&visitor);
 				}
 			}
-			g_equippedAmmoFormID = kInvalid;
+			g_equippedAmmo.Clear(letter);
 		}
 	}
 
 
 	void DelayedAmmoTaskDelegate::Dispose()
 	{
-		delete this;
+		TaskPool<DelayedAmmoTaskDelegate>::Release(this);
 	}
 
 
-	bool TESEquipEventHandler::Visitor::Accept(RE::InventoryEntryData* a_entry, SInt32 a_count)
+	bool EquipHandler::Visitor::Accept(InventoryEntryView* a_entry, SInt32 a_count)
 	{
 		if (a_entry->object->formID == Ammo::GetSingleton()->GetFormID() && a_entry->extraLists) {
-			auto equipManager = RE::ActorEquipManager::GetSingleton();
-			auto player = RE::PlayerCharacter::GetSingleton();
 			auto xList = a_entry->extraLists->empty() ? 0 : a_entry->extraLists->front();
-			equipManager->UnequipItem(player, a_entry->object, xList, a_count, 0, true, false);
+			UnEquipPlayerItem(a_entry->object, xList, a_count, 0);
 			return false;
 		}
 		return true;
 	}
 
 
-	TESEquipEventHandler* TESEquipEventHandler::GetSingleton()
+	bool EquipHandler::Enabled()
 	{
-		static TESEquipEventHandler singleton;
-		return &singleton;
+		return Settings::manageAmmo;
 	}
 
 
-	auto TESEquipEventHandler::ProcessEvent(const RE::TESEquipEvent* a_event, RE::BSTEventSource<RE::TESEquipEvent>* a_eventSource)
-		-> EventResult
+	void EquipHandler::OnEquip(RE::TESForm* a_form, bool a_equipped)
 	{
-		if (!a_event || !a_event->hActor || !a_event->hActor->IsPlayerRef() || PlayerIsBeastRace()) {
-			return EventResult::kContinue;
-		}
-
-		auto form = RE::TESForm::LookupByID(a_event->baseObject);
-		if (!form) {
-			return EventResult::kContinue;
-		}
-
-		auto task = SKSE::GetTaskInterface();
-		switch (form->formType) {
+		switch (a_form->formType) {
 		case RE::FormType::Weapon:
-			if (a_event->equipped) {
-				g_equippedWeaponFormID = form->formID;
-				task->AddTask(new DelayedWeaponTaskDelegate());
+			if (a_equipped) {
+				g_equippedWeapon.Post(a_form->formID);
+				Scheduler::AddTask(TaskPool<DelayedWeaponTaskDelegate>::Create(), Scheduler::Priority::kEquip);
 			} else {
 				Visitor visitor;
 				VisitPlayerInventoryChanges(&visitor);
 			}
 			break;
 		case RE::FormType::Ammo:
-			if (a_event->equipped) {
-				g_equippedAmmoFormID = form->formID;
-				task->AddTask(new DelayedAmmoTaskDelegate());
+			if (a_equipped) {
+				g_equippedAmmo.Post(a_form->formID);
+				Scheduler::AddTask(TaskPool<DelayedAmmoTaskDelegate>::Create(), Scheduler::Priority::kEquip);
 			}
 			break;
 		}
-		return EventResult::kContinue;
 	}
 }
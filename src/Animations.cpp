@@ -1,12 +1,116 @@
 #include "Animations.h"
 
-#include <cctype>  // tolower
-#include <string>  // string
+#include <atomic>  // atomic
+#include <cstdint>  // uintptr_t
 #include <string_view>  // string_view
 
 #include "RE/Skyrim.h"
 
 
+namespace
+{
+	// BSFixedStrings are interned, so a tag's data pointer identifies it for as long as the string lives
+	// Each thread keeps a small open-addressed cache from that pointer to the tag's hash
+	// Bumping the epoch drops every thread's cache, for when graphs (and their strings) may have been freed
+	class AnimationCache
+	{
+	public:
+		enum : std::size_t
+		{
+			kSize = 64,	// must be a power of two
+			kMaxProbe = 4
+		};
+
+
+		static AnimationCache* GetSingleton()
+		{
+			thread_local AnimationCache singleton;
+			return &singleton;
+		}
+
+
+		static void Clear()
+		{
+			++_epoch;
+		}
+
+
+		bool Find(const char* a_key, std::uint32_t a_len, Anim& a_anim)
+		{
+			Sync();
+
+			auto idx = Index(a_key);
+			for (std::size_t i = 0; i < kMaxProbe; ++i) {
+				auto& slot = _slots[(idx + i) & (kSize - 1)];
+				if (slot.key == a_key) {
+					if (slot.len != a_len) {
+						return false;
+					}
+					a_anim = slot.anim;
+					return true;
+				} else if (!slot.key) {
+					return false;
+				}
+			}
+			return false;
+		}
+
+
+		void Insert(const char* a_key, std::uint32_t a_len, Anim a_anim)
+		{
+			auto idx = Index(a_key);
+			for (std::size_t i = 0; i < kMaxProbe; ++i) {
+				auto& slot = _slots[(idx + i) & (kSize - 1)];
+				if (!slot.key || slot.key == a_key) {
+					slot = { a_key, a_len, a_anim };
+					return;
+				}
+			}
+			_slots[idx] = { a_key, a_len, a_anim };
+		}
+
+	private:
+		struct Slot
+		{
+			const char* key;
+			std::uint32_t len;
+			Anim anim;
+		};
+
+
+		AnimationCache() :
+			_slots{},
+			_localEpoch(_epoch)
+		{}
+
+
+		void Sync()
+		{
+			std::uint32_t epoch = _epoch;
+			if (_localEpoch != epoch) {
+				for (auto& slot : _slots) {
+					slot = { 0, 0, Anim(0) };
+				}
+				_localEpoch = epoch;
+			}
+		}
+
+
+		static std::size_t Index(const char* a_key)
+		{
+			auto addr = reinterpret_cast<std::uintptr_t>(a_key);
+			return static_cast<std::size_t>(((addr >> 4) * 0x9E3779B97F4A7C15) >> 58) & (kSize - 1);
+		}
+
+
+		Slot _slots[kSize];
+		std::uint32_t _localEpoch;
+
+		static inline std::atomic<std::uint32_t> _epoch = 0;
+	};
+}
+
+
 Anim HashAnimation(const char* a_str, std::uint32_t a_len)
 {
 	return Anim(hash_64_fnv1a(a_str, a_len));
@@ -15,11 +119,23 @@ Anim HashAnimation(const char* a_str, std::uint32_t a_len)
 
 Anim HashAnimation(const RE::BSFixedString& a_str)
 {
-	std::string str = "";
-	str.reserve(a_str.size());
 	std::string_view view = a_str;
-	for (auto ch : view) {
-		str += std::tolower(ch);
+	if (view.empty()) {
+		return Anim(hash_64_fnv1a_lower(view.data(), view.size()));
+	}
+
+	auto cache = AnimationCache::GetSingleton();
+	auto len = static_cast<std::uint32_t>(view.size());
+	Anim anim;
+	if (!cache->Find(view.data(), len, anim)) {
+		anim = Anim(hash_64_fnv1a_lower(view.data(), view.size()));
+		cache->Insert(view.data(), len, anim);
 	}
-	return HashAnimation(str.c_str(), str.length());
+	return anim;
+}
+
+
+void ClearAnimationCache()
+{
+	AnimationCache::Clear();
 }
@@ -0,0 +1,238 @@
+#include "Events.h"
+
+#include "Ammo.h"  // Ammo::EquipHandler
+#include "Animations.h"  // Anim, HashAnimation, ClearAnimationCache
+#include "Forms.h"  // InvalidateFormCache
+#include "ManagedSlots.h"  // ManagedSlots
+#include "Metrics.h"  // ScopedTimer, Metric
+#include "PlayerInventory.h"  // PlayerInventory, AmmoCounts
+#include "PlayerUtil.h"  // SinkAnimationGraphEventHandler, PlayerIsBeastRace, UpdatePlayerBeastRace
+#include "Scheduler.h"  // AddTask, Priority
+#include "TaskPool.h"  // TaskPool
+#include "Trace.h"  // IsRecording, Record, IsReplaying, Kind
+#include "WornSlots.h"  // WornSlots
+
+#include "RE/Skyrim.h"
+
+
+namespace Events
+{
+	BSAnimationGraphEventHandler* BSAnimationGraphEventHandler::GetSingleton()
+	{
+		static BSAnimationGraphEventHandler singleton;
+		return &singleton;
+	}
+
+
+	auto BSAnimationGraphEventHandler::ProcessEvent(const RE::BSAnimationGraphEvent* a_event, RE::BSTEventSource<RE::BSAnimationGraphEvent>* a_eventSource)
+		-> EventResult
+	{
+		Metrics::ScopedTimer timer(Metrics::Metric::kAnimationEvent);
+
+		if (!a_event) {
+			return EventResult::kContinue;
+		}
+
+		auto isPlayer = a_event->holder && a_event->holder->IsPlayerRef();
+		if (Trace::IsRecording()) {
+			Trace::Record(Trace::Kind::kAnimation, static_cast<UInt64>(HashAnimation(a_event->tag)), isPlayer);
+		}
+
+		if (!isPlayer) {
+			return EventResult::kContinue;
+		}
+
+		DispatchAnimation(HashAnimation(a_event->tag));
+
+		return EventResult::kContinue;
+	}
+
+
+	TESEquipEventHandler* TESEquipEventHandler::GetSingleton()
+	{
+		static TESEquipEventHandler singleton;
+		return &singleton;
+	}
+
+
+	auto TESEquipEventHandler::ProcessEvent(const RE::TESEquipEvent* a_event, RE::BSTEventSource<RE::TESEquipEvent>* a_eventSource)
+		-> EventResult
+	{
+		Metrics::ScopedTimer timer(Metrics::Metric::kEquipEvent);
+
+		if (!a_event) {
+			return EventResult::kContinue;
+		}
+
+		auto isPlayer = a_event->hActor.get() == RE::PlayerCharacter::GetSingleton();
+		Trace::Record(Trace::Kind::kEquip, a_event->baseObject, isPlayer, a_event->equipped);
+
+		if (!isPlayer) {
+			return EventResult::kContinue;
+		}
+
+		DispatchEquip(a_event->baseObject, a_event->equipped);
+
+		return EventResult::kContinue;
+	}
+
+
+	TESObjectLoadedEventHandler* TESObjectLoadedEventHandler::GetSingleton()
+	{
+		static TESObjectLoadedEventHandler singleton;
+		return &singleton;
+	}
+
+
+	auto TESObjectLoadedEventHandler::ProcessEvent(const RE::TESObjectLoadedEvent* a_event, RE::BSTEventSource<RE::TESObjectLoadedEvent>* a_eventSource)
+		-> EventResult
+	{
+		Metrics::ScopedTimer timer(Metrics::Metric::kObjectLoadedEvent);
+
+		if (!a_event) {
+			return EventResult::kContinue;
+		}
+
+		auto isPlayer = a_event->formID == RE::PlayerCharacter::GetSingleton()->formID;
+		Trace::Record(Trace::Kind::kObjectLoaded, a_event->formID, isPlayer);
+
+		if (isPlayer) {
+			DispatchPlayerLoaded();
+		}
+
+		return EventResult::kContinue;
+	}
+
+
+	TESSwitchRaceCompleteEventHandler* TESSwitchRaceCompleteEventHandler::GetSingleton()
+	{
+		static TESSwitchRaceCompleteEventHandler singleton;
+		return &singleton;
+	}
+
+
+	auto TESSwitchRaceCompleteEventHandler::ProcessEvent(const RE::TESSwitchRaceCompleteEvent* a_event, RE::BSTEventSource<RE::TESSwitchRaceCompleteEvent>* a_eventSource)
+		-> EventResult
+	{
+		Metrics::ScopedTimer timer(Metrics::Metric::kSwitchRaceEvent);
+
+		if (!a_event) {
+			return EventResult::kContinue;
+		}
+
+		auto subject = a_event->subject.get();
+		auto isPlayer = subject == RE::PlayerCharacter::GetSingleton();
+		Trace::Record(Trace::Kind::kSwitchRace, subject ? subject->formID : 0, isPlayer);
+
+		if (!isPlayer) {
+			return EventResult::kContinue;
+		}
+
+		UpdatePlayerBeastRace();
+
+		return EventResult::kContinue;
+	}
+
+
+	void AnimGraphSinkDelegate::Run()
+	{
+		Metrics::ScopedTimer timer(Metrics::Metric::kAnimGraphSinkTask);
+
+		ClearAnimationCache();
+		SinkAnimationGraphEventHandler(BSAnimationGraphEventHandler::GetSingleton());
+	}
+
+
+	void AnimGraphSinkDelegate::Dispose()
+	{
+		TaskPool<AnimGraphSinkDelegate>::Release(this);
+	}
+
+
+	void DispatchAnimation(Anim a_anim)
+	{
+		switch (a_anim) {
+		case Anim::kWeaponDraw:
+			if (!PlayerIsBeastRace()) {
+				ManagedSlots::OnWeaponDraw();
+			}
+			break;
+		case Anim::kWeaponSheathe:
+			if (!PlayerIsBeastRace()) {
+				ManagedSlots::OnWeaponSheathe();
+			}
+			break;
+		case Anim::kTailCombatIdle:
+			if (!PlayerIsBeastRace()) {
+				ManagedSlots::OnTailCombatIdle();
+			}
+			break;
+		case Anim::kGraphDeleting:
+			Scheduler::AddTask(TaskPool<AnimGraphSinkDelegate>::Create(), Scheduler::Priority::kBookkeeping);
+			break;
+		}
+	}
+
+
+	void DispatchEquip(RE::FormID a_formID, bool a_equipped)
+	{
+		auto form = RE::TESForm::LookupByID(a_formID);
+		if (!form) {
+			return;
+		}
+		_DMESSAGE("Player %s (%08X)", a_equipped ? "equipped" : "unequipped", a_formID);
+
+		// Equipping an item only held in the base container gives it a changes entry, which no container change event announces
+		Inventory::PlayerInventory::GetSingleton()->Invalidate(a_formID);
+
+		// Worn slots are tracked in every form, so they are still right after a beast form ends
+		// A replayed event did not change what the player wears
+		if (form->formType == RE::FormType::Armor && !Trace::IsReplaying()) {
+			Inventory::WornSlots::GetSingleton()->Update(static_cast<RE::TESObjectARMO*>(form), a_equipped);
+		}
+
+		if (PlayerIsBeastRace()) {
+			return;
+		}
+
+		switch (form->formType) {
+		case RE::FormType::Weapon:
+		case RE::FormType::Ammo:
+			if (Ammo::EquipHandler::Enabled()) {
+				Ammo::EquipHandler::OnEquip(form, a_equipped);
+			}
+			break;
+		case RE::FormType::Armor:
+			ManagedSlots::OnEquip(static_cast<RE::TESObjectARMO*>(form), a_equipped);
+			break;
+		}
+	}
+
+
+	void DispatchPlayerLoaded()
+	{
+		Inventory::PlayerInventory::GetSingleton()->Invalidate();
+		Inventory::AmmoCounts::GetSingleton()->Invalidate();
+		Inventory::WornSlots::GetSingleton()->Invalidate();
+		InvalidateFormCache();
+		UpdatePlayerBeastRace();
+
+		if (AnimationEventsEnabled()) {
+			if (SinkAnimationGraphEventHandler(BSAnimationGraphEventHandler::GetSingleton())) {
+				_MESSAGE("Registered player animation event handler");
+			}
+		}
+	}
+
+
+	bool AnimationEventsEnabled()
+	{
+		return ManagedSlots::Enabled();
+	}
+
+
+	bool EquipEventsEnabled()
+	{
+		return Ammo::EquipHandler::Enabled() || ManagedSlots::Enabled();
+	}
+}
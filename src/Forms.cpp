@@ -1,8 +1,29 @@
 #include "Forms.h"
 
+#include <atomic>  // atomic
+
 #include "RE/Skyrim.h"
 
 
+namespace
+{
+	std::atomic<UInt32> g_formCacheGeneration = 1;
+}
+
+
+UInt32 GetFormCacheGeneration()
+{
+	return g_formCacheGeneration;
+}
+
+
+void InvalidateFormCache()
+{
+	++g_formCacheGeneration;
+}
+
+
+
 decltype(WeapTypeBoundArrow)	WeapTypeBoundArrow(kWeapTypeBoundArrow, "Skyrim.esm");
 decltype(WerewolfBeastRace)		WerewolfBeastRace(kWerewolfBeastRace, "Skyrim.esm");
 decltype(DLC1VampireBeastRace)	DLC1VampireBeastRace(kDLC1VampireBeastRace, "Dawnguard.esm");
@@ -5,8 +5,12 @@
 
 #include <type_traits>  // typeid
 
-#include "Animations.h"  // Anim, HashAnimation
 #include "Forms.h"  // WerewolfBeastRace, DLC1VampireBeastRace
+#include "Metrics.h"  // ScopedTimer, Metric
+#include "PlayerUtil.h"  // VisitPlayerInventoryChanges
+#include "Scheduler.h"  // AddTask, Priority
+#include "Settings.h"  // Settings
+#include "TaskPool.h"  // TaskPool
 
 #include "RE/Skyrim.h"
 #include "SKSE/API.h"
@@ -25,30 +29,23 @@ namespace Helmet
 	{
 		ISerializableForm::Clear();
 		_enchantment.Clear();
+		_health = ItemFingerprint::kUntempered;
 	}
 
 
-	bool Helmet::Save(SKSE::SerializationInterface* a_intfc, UInt32 a_type, UInt32 a_version)
+	void Helmet::Save(SlotRecord& a_record)
 	{
-		if (!ISerializableForm::Save(a_intfc, a_type, a_version)) {
-			return false;
-		} else if (!_enchantment.Save(a_intfc)) {
-			return false;
-		} else {
-			return true;
-		}
+		ISerializableForm::Save(a_record);
+		a_record.enchantment = _enchantment.GetFormID();
+		a_record.health = _health;
 	}
 
 
-	bool Helmet::Load(SKSE::SerializationInterface* a_intfc)
+	void Helmet::Load(const SlotRecord& a_record)
 	{
-		if (!ISerializableForm::Load(a_intfc)) {
-			return false;
-		} else if (!_enchantment.Load(a_intfc)) {
-			return false;
-		} else {
-			return true;
-		}
+		ISerializableForm::Load(a_record);
+		_enchantment.SetForm(a_record.enchantment);
+		_health = a_record.health;
 	}
 
 
@@ -58,108 +55,46 @@ namespace Helmet
 	}
 
 
-	void Helmet::SetEnchantmentForm(UInt32 a_formID)
-	{
-		_enchantment.SetForm(a_formID);
-	}
-
-
-	RE::EnchantmentItem* Helmet::GetEnchantmentForm()
-	{
-		return _enchantment.GetForm();
-	}
-
-
 	UInt32 Helmet::GetEnchantmentFormID()
 	{
 		return _enchantment.GetFormID();
 	}
 
 
-	RE::EnchantmentItem* Helmet::Enchantment::GetForm()
+	void Helmet::SetInstance(const ItemFingerprint& a_instance)
 	{
-		return static_cast<RE::EnchantmentItem*>(ISerializableForm::GetForm());
+		SetForm(a_instance.formID);
+		_enchantment.SetForm(a_instance.enchantment);
+		_health = a_instance.health;
 	}
 
 
-	void HelmetTaskDelegate::Run()
+	bool Helmet::Matches(const ItemFingerprint& a_instance)
 	{
-		if (_equip) {
-			HelmetEquipVisitor visitor;
-			VisitPlayerInventoryChanges(&visitor);
+		if (_health == kAnyHealth) {
+			return MatchesIgnoringHealth(a_instance);
 		} else {
-			HelmetUnEquipVisitor visitor;
-			VisitPlayerInventoryChanges(&visitor);
+			return a_instance == ItemFingerprint(GetFormID(), GetEnchantmentFormID(), _health);
 		}
 	}
 
 
-	void HelmetTaskDelegate::Dispose()
+	// Tempering at a workbench changes a copy's health without an equip, so the remembered health can go stale
+	bool Helmet::MatchesIgnoringHealth(const ItemFingerprint& a_instance)
 	{
-		delete this;
+		return a_instance.formID == GetFormID() && a_instance.enchantment == GetEnchantmentFormID();
 	}
 
 
-	DelayedHelmetLocator::Visitor::Visitor(UInt32 a_formID) :
-		_formID(a_formID)
+	Helmet::Helmet() :
+		ISerializableForm(),
+		_enchantment(),
+		_health(ItemFingerprint::kUntempered)
 	{}
 
 
-	bool HelmetTaskDelegate::HelmetEquipVisitor::Accept(RE::InventoryEntryData* a_entry, SInt32 a_count)
-	{
-		auto helmet = Helmet::GetSingleton();
-		if (a_entry->object->formID == helmet->GetFormID()) {
-			auto armor = static_cast<RE::TESObjectARMO*>(a_entry->object);
-			auto enchantment = helmet->GetEnchantmentForm();
-			if (enchantment) {
-				if (!a_entry->extraLists) {
-					return true;
-				}
-				bool found = false;
-				for (auto& xList : *a_entry->extraLists) {
-					auto xEnch = xList->GetByType<RE::ExtraEnchantment>();
-					if (xEnch && xEnch->enchantment && xEnch->enchantment->formID == enchantment->formID) {
-						found = true;
-						break;
-					}
-				}
-				if (!found) {
-					return true;
-				}
-			}
-			auto equipManager = RE::ActorEquipManager::GetSingleton();
-			auto player = RE::PlayerCharacter::GetSingleton();
-			auto xList = (a_entry->extraLists && !a_entry->extraLists->empty()) ? a_entry->extraLists->front() : 0;
-			equipManager->EquipItem(player, armor, xList, 1, armor->equipSlot, true, false, false);
-			return false;
-		}
-		return true;
-	}
-
-
-	bool HelmetTaskDelegate::HelmetUnEquipVisitor::Accept(RE::InventoryEntryData* a_entry, SInt32 a_count)
-	{
-		using FirstPersonFlag = RE::BIPED_MODEL::BipedObjectSlot;
-
-		if (a_entry->object && a_entry->object->Is(RE::FormType::Armor) && a_entry->extraLists) {
-			for (auto& xList : *a_entry->extraLists) {
-				if (xList->HasType(RE::ExtraDataType::kWorn)) {
-					auto armor = static_cast<RE::TESObjectARMO*>(a_entry->object);
-					if (armor->HasPartOf(FirstPersonFlag::kHair) && (armor->IsLightArmor() || armor->IsHeavyArmor())) {
-						auto equipManager = RE::ActorEquipManager::GetSingleton();
-						auto player = RE::PlayerCharacter::GetSingleton();
-						equipManager->UnequipItem(player, armor, xList, 1, armor->equipSlot, true, false);
-						return false;
-					}
-				}
-			}
-		}
-		return true;
-	}
-
-
-	HelmetTaskDelegate::HelmetTaskDelegate(bool a_equip) :
-		_equip(a_equip)
+	DelayedHelmetLocator::Visitor::Visitor(UInt32 a_formID) :
+		_formID(a_formID)
 	{}
 
 
@@ -170,6 +105,8 @@ namespace Helmet
 
 	void DelayedHelmetLocator::Run()
 	{
+		Metrics::ScopedTimer timer(Metrics::Metric::kDelayedHelmetLocator);
+
 		Visitor visitor(_formID);
 		VisitPlayerInventoryChanges(&visitor);
 	}
@@ -177,27 +114,16 @@ namespace Helmet
 
 	void DelayedHelmetLocator::Dispose()
 	{
-		delete this;
+		TaskPool<DelayedHelmetLocator>::Release(this);
 	}
 
 
-	bool DelayedHelmetLocator::Visitor::Accept(RE::InventoryEntryData* a_entry, SInt32 a_count)
+	bool DelayedHelmetLocator::Visitor::Accept(InventoryEntryView* a_entry, SInt32 a_count)
 	{
 		if (a_entry->object->formID == _formID && a_entry->extraLists) {
 			for (auto& xList : *a_entry->extraLists) {
 				if (xList->HasType(RE::ExtraDataType::kWorn)) {
-					auto helmet = Helmet::GetSingleton();
-					helmet->Clear();
-					helmet->SetForm(_formID);
-					auto armor = static_cast<RE::TESObjectARMO*>(a_entry->object);
-					for (auto& xList : *a_entry->extraLists) {
-						if (xList->HasType(RE::ExtraDataType::kEnchantment)) {
-							auto ench = xList->GetByType<RE::ExtraEnchantment>();
-							if (ench && ench->enchantment) {
-								helmet->SetEnchantmentForm(ench->enchantment->formID);
-							}
-						}
-					}
+					Helmet::GetSingleton()->SetInstance(ItemFingerprint(a_entry->object, xList));
 					return false;
 				}
 			}
@@ -206,90 +132,82 @@ namespace Helmet
 	}
 
 
-	void AnimGraphSinkDelegate::Run()
-	{
-		SinkAnimationGraphEventHandler(BSAnimationGraphEventHandler::GetSingleton());
-	}
-
-
-	void AnimGraphSinkDelegate::Dispose()
+	bool HelmetPolicy::Enabled()
 	{
-		delete this;
+		return Settings::manageHelmet;
 	}
 
 
-	TESEquipEventHandler* TESEquipEventHandler::GetSingleton()
+	// An exact copy is preferred, then any copy of the same form and enchantment, whose health the locator refreshes once it is worn
+	// Copies without extra data share the plain fingerprint, and only exist when the count exceeds the number of extra lists
+	bool HelmetPolicy::IsRemembered(InventoryEntryView* a_entry, SInt32 a_count, RE::ExtraDataList*& a_xList)
 	{
-		static TESEquipEventHandler singleton;
-		return &singleton;
-	}
-
-
-	auto TESEquipEventHandler::ProcessEvent(const RE::TESEquipEvent* a_event, RE::BSTEventSource<RE::TESEquipEvent>* a_eventSource)
-		-> EventResult
-	{
-		using FirstPersonFlag = RE::BIPED_MODEL::BipedObjectSlot;
-
-		if (!a_event || !a_event->hActor || !a_event->hActor->IsPlayerRef() || PlayerIsBeastRace()) {
-			return EventResult::kContinue;
-		}
-
-		auto armor = RE::TESForm::LookupByID<RE::TESObjectARMO>(a_event->baseObject);
-		if (!armor) {
-			return EventResult::kContinue;
+		auto helmet = Helmet::GetSingleton();
+		if (a_entry->object->formID != helmet->GetFormID()) {
+			return false;
 		}
 
-		if (armor->HasPartOf(FirstPersonFlag::kHead | FirstPersonFlag::kHair | FirstPersonFlag::kCirclet)) {
-			auto helmet = Helmet::GetSingleton();
-			if (armor->IsLightArmor() || armor->IsHeavyArmor()) {
-				if (a_event->equipped) {
-					SKSE::GetTaskInterface()->AddTask(new DelayedHelmetLocator(armor->formID));
-				} else {
-					auto player = RE::PlayerCharacter::GetSingleton();
-					if (player->IsWeaponDrawn()) {
-						helmet->Clear();
-					}
+		SInt32 numLists = 0;
+		RE::ExtraDataList* retempered = 0;
+		bool foundRetempered = false;
+		if (a_entry->extraLists) {
+			for (auto& xList : *a_entry->extraLists) {
+				ItemFingerprint instance(a_entry->object, xList);
+				if (helmet->Matches(instance)) {
+					a_xList = xList;
+					return true;
+				} else if (!foundRetempered && helmet->MatchesIgnoringHealth(instance)) {
+					retempered = xList;
+					foundRetempered = true;
 				}
-			} else {
-				helmet->Clear();
+				++numLists;
 			}
 		}
 
-		return EventResult::kContinue;
+		ItemFingerprint plain(a_entry->object, 0);
+		bool hasPlain = a_count > numLists;
+		if (hasPlain && helmet->Matches(plain)) {
+			a_xList = 0;
+			return true;
+		} else if (foundRetempered) {
+			a_xList = retempered;
+			return true;
+		} else if (hasPlain && helmet->MatchesIgnoringHealth(plain)) {
+			a_xList = 0;
+			return true;
+		} else {
+			return false;
+		}
 	}
 
 
-	BSAnimationGraphEventHandler* BSAnimationGraphEventHandler::GetSingleton()
+	// A worn copy that differs only in health is the remembered helmet after tempering, so it is not swapped out
+	bool HelmetPolicy::IsRememberedInstance(const ItemFingerprint& a_instance)
 	{
-		static BSAnimationGraphEventHandler singleton;
-		return &singleton;
+		return Helmet::GetSingleton()->MatchesIgnoringHealth(a_instance);
 	}
 
 
-	auto BSAnimationGraphEventHandler::ProcessEvent(const RE::BSAnimationGraphEvent* a_event, RE::BSTEventSource<RE::BSAnimationGraphEvent>* a_eventSource)
-		-> EventResult
+	bool HelmetPolicy::IsManagedArmor(RE::TESObjectARMO* a_armor)
 	{
-		if (!a_event || !a_event->holder || !a_event->holder->IsPlayerRef()) {
-			return EventResult::kContinue;
-		}
+		return a_armor->HasPartOf(FirstPersonFlag::kHair) && (a_armor->IsLightArmor() || a_armor->IsHeavyArmor());
+	}
 
-		auto task = SKSE::GetTaskInterface();
-		switch (HashAnimation(a_event->tag)) {
-		case Anim::kWeaponDraw:
-			if (!PlayerIsBeastRace()) {
-				task->AddTask(new HelmetTaskDelegate(true));
-			}
-			break;
-		case Anim::kWeaponSheathe:
-			if (!PlayerIsBeastRace()) {
-				task->AddTask(new HelmetTaskDelegate(false));
+
+	void HelmetPolicy::OnEquip(RE::TESObjectARMO* a_armor, bool a_equipped)
+	{
+		auto helmet = Helmet::GetSingleton();
+		if (a_armor->IsLightArmor() || a_armor->IsHeavyArmor()) {
+			if (a_equipped) {
+				Scheduler::AddTask(TaskPool<DelayedHelmetLocator>::Create(a_armor->formID), Scheduler::Priority::kBookkeeping);
+			} else {
+				auto player = RE::PlayerCharacter::GetSingleton();
+				if (player->IsWeaponDrawn()) {
+					helmet->Clear();
+				}
 			}
-			break;
-		case Anim::kGraphDeleting:
-			task->AddTask(new AnimGraphSinkDelegate());
-			break;
+		} else {
+			helmet->Clear();
 		}
-
-		return EventResult::kContinue;
 	}
 }
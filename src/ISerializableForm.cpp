@@ -1,61 +1,72 @@
 #include "ISerializableForm.h"
 
+#include "Forms.h"  // GetFormCacheGeneration
+
 #include "RE/Skyrim.h"
-#include "SKSE/Interfaces.h"
 
 
 ISerializableForm::ISerializableForm() :
-	_formID(kInvalid)
+	_formID(kInvalid),
+	_form(0),
+	_cacheGeneration(0)
 {}
 
 
 void ISerializableForm::Clear()
 {
 	_formID = kInvalid;
+	_form = 0;
+	_cacheGeneration = 0;
 }
 
 
-bool ISerializableForm::Save(SKSE::SerializationInterface* a_intfc, UInt32 a_type, UInt32 a_version)
+void ISerializableForm::Save(SlotRecord& a_record)
 {
-	if (!a_intfc->OpenRecord(a_type, a_version)) {
-		_ERROR("Failed to open serialization record!\n");
-		return false;
-	} else {
-		return Save(a_intfc);
-	}
+	a_record.formID = _formID;
+	a_record.enchantment = kInvalid;
+	a_record.health = 0.0F;
 }
 
 
-bool ISerializableForm::Save(SKSE::SerializationInterface* a_intfc)
+void ISerializableForm::Load(const SlotRecord& a_record)
 {
-	a_intfc->WriteRecordData(&_formID, sizeof(_formID));
-
-	return true;
+	_formID = a_record.formID;
+	_form = 0;
+	_cacheGeneration = 0;
 }
 
 
-bool ISerializableForm::Load(SKSE::SerializationInterface* a_intfc)
+void ISerializableForm::SetForm(UInt32 a_formID)
 {
-	a_intfc->ReadRecordData(&_formID, sizeof(_formID));
-	if (!a_intfc->ResolveFormID(_formID, _formID)) {
-		_ERROR("Failed to resolve formID");
-		_formID = kInvalid;
-		return false;
+	if (_formID != a_formID) {
+		_formID = a_formID;
+		_form = 0;
+		_cacheGeneration = 0;
 	}
-
-	return true;
 }
 
 
-void ISerializableForm::SetForm(UInt32 a_formID)
+RE::TESForm* ISerializableForm::GetForm()
 {
-	_formID = a_formID;
-}
+	if (_formID == kInvalid) {
+		return 0;
+	}
 
+	auto generation = GetFormCacheGeneration();
+	if (_form && _cacheGeneration == generation) {
+#if _DEBUG
+		auto form = RE::TESForm::LookupByID(_formID);
+		if (form != _form) {
+			_ERROR("Cached form (%08X) is out of date!", _formID);
+			_form = form;
+		}
+#endif
+		return _form;
+	}
 
-RE::TESForm* ISerializableForm::GetForm()
-{
-	return _formID == kInvalid ? 0 : RE::TESForm::LookupByID(_formID);
+	_form = RE::TESForm::LookupByID(_formID);
+	_cacheGeneration = generation;
+	return _form;
 }
 
 
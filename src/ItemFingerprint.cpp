@@ -0,0 +1,52 @@
+#include "ItemFingerprint.h"
+
+#include "ISerializableForm.h"  // kInvalid
+
+#include "RE/Skyrim.h"
+
+
+ItemFingerprint::ItemFingerprint() :
+	formID(kInvalid),
+	enchantment(kInvalid),
+	health(kUntempered)
+{}
+
+
+ItemFingerprint::ItemFingerprint(FormID a_formID, FormID a_enchantment, float a_health) :
+	formID(a_formID),
+	enchantment(a_enchantment),
+	health(a_health)
+{}
+
+
+ItemFingerprint::ItemFingerprint(RE::TESBoundObject* a_object, RE::ExtraDataList* a_xList) :
+	formID(a_object->formID),
+	enchantment(kInvalid),
+	health(kUntempered)
+{
+	if (!a_xList) {
+		return;
+	}
+
+	auto xEnch = a_xList->GetByType<RE::ExtraEnchantment>();
+	if (xEnch && xEnch->enchantment) {
+		enchantment = xEnch->enchantment->formID;
+	}
+
+	auto xHealth = a_xList->GetByType<RE::ExtraHealth>();
+	if (xHealth) {
+		health = xHealth->health;
+	}
+}
+
+
+bool ItemFingerprint::operator==(const ItemFingerprint& a_rhs) const
+{
+	return formID == a_rhs.formID && enchantment == a_rhs.enchantment && health == a_rhs.health;
+}
+
+
+bool ItemFingerprint::operator!=(const ItemFingerprint& a_rhs) const
+{
+	return !operator==(a_rhs);
+}
@@ -0,0 +1,194 @@
+#include "Log.h"
+
+#include <atomic>  // atomic
+#include <chrono>  // duration_cast, milliseconds, system_clock
+#include <cstdarg>  // va_list, va_start, va_end
+#include <cstdint>  // intptr_t
+#include <cstdio>  // FILE, vsnprintf, fprintf, fflush, _wfopen_s
+#include <ctime>  // time_t, tm, localtime_s
+#include <mutex>  // mutex, lock_guard
+#include <string>  // wstring
+#include <thread>  // thread, sleep_for
+
+#include <ShlObj.h>  // SHGetKnownFolderPath
+
+
+namespace Log
+{
+	namespace
+	{
+		using Clock = std::chrono::system_clock;
+
+
+		enum : std::size_t
+		{
+			kCapacity = 1 << 10,
+			kMask = kCapacity - 1,
+			kMessageSize = 512
+		};
+		static_assert((kCapacity & kMask) == 0);
+
+
+		constexpr auto kIdleInterval = std::chrono::milliseconds(10);
+
+
+		struct Slot
+		{
+			std::atomic<std::size_t> sequence;
+			Clock::time_point time;
+			char message[kMessageSize];
+		};
+
+
+		// Bounded MPSC ring, a slot is free for position p when its sequence is p and full when it is p + 1
+		Slot g_ring[kCapacity];
+		std::atomic<std::size_t> g_head = 0;
+		std::size_t g_tail = 0;
+		std::atomic<std::size_t> g_dropped = 0;
+		std::atomic<bool> g_async = false;
+		std::atomic<Level> g_printLevel = Level::kDebugMessage;
+
+		std::mutex g_fileLock;
+		std::FILE* g_file = 0;
+
+
+		void Write(Clock::time_point a_time, const char* a_message)
+		{
+			auto time = Clock::to_time_t(a_time);
+			auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(a_time.time_since_epoch()).count() % 1000;
+			std::tm local;
+			localtime_s(&local, &time);
+			std::fprintf(g_file, "[%02d:%02d:%02d.%03d] %s\n", local.tm_hour, local.tm_min, local.tm_sec, static_cast<int>(milliseconds), a_message);
+		}
+
+
+		bool TryPush(Clock::time_point a_time, const char* a_format, std::va_list a_args)
+		{
+			auto pos = g_head.load(std::memory_order_relaxed);
+			Slot* slot = 0;
+			while (true) {
+				slot = &g_ring[pos & kMask];
+				auto diff = static_cast<std::intptr_t>(slot->sequence.load(std::memory_order_acquire)) - static_cast<std::intptr_t>(pos);
+				if (diff == 0) {
+					if (g_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+						break;
+					}
+				} else if (diff < 0) {
+					return false;
+				} else {
+					pos = g_head.load(std::memory_order_relaxed);
+				}
+			}
+
+			slot->time = a_time;
+			std::vsnprintf(slot->message, kMessageSize, a_format, a_args);
+			slot->sequence.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+
+		// Writes every message published so far and flushes once, returns false if the ring was empty
+		bool Drain()
+		{
+			std::lock_guard<std::mutex> locker(g_fileLock);
+			bool wrote = false;
+			while (true) {
+				auto& slot = g_ring[g_tail & kMask];
+				if (slot.sequence.load(std::memory_order_acquire) != g_tail + 1) {
+					break;
+				}
+
+				if (g_file) {
+					Write(slot.time, slot.message);
+				}
+				slot.sequence.store(g_tail + kCapacity, std::memory_order_release);
+				++g_tail;
+				wrote = true;
+			}
+
+			if (wrote && g_file) {
+				std::fflush(g_file);
+			}
+			return wrote;
+		}
+	}
+
+
+	bool Open(const KNOWNFOLDERID& a_id, const wchar_t* a_relativePath)
+	{
+		wchar_t* folder = 0;
+		if (FAILED(SHGetKnownFolderPath(a_id, KF_FLAG_DEFAULT, 0, &folder))) {
+			CoTaskMemFree(folder);
+			return false;
+		}
+		std::wstring path(folder);
+		path += a_relativePath;
+		CoTaskMemFree(folder);
+
+		std::lock_guard<std::mutex> locker(g_fileLock);
+		if (g_file) {
+			return false;
+		}
+		return _wfopen_s(&g_file, path.c_str(), L"w") == 0;
+	}
+
+
+	void SetPrintLevel(Level a_level)
+	{
+		g_printLevel = a_level;
+	}
+
+
+	void StartWriter()
+	{
+		if (g_async) {
+			return;
+		}
+
+		for (std::size_t i = 0; i < kCapacity; ++i) {
+			g_ring[i].sequence.store(i, std::memory_order_relaxed);
+		}
+		g_async = true;
+
+		std::thread([]()
+		{
+			while (true) {
+				if (!Drain()) {
+					std::this_thread::sleep_for(kIdleInterval);
+				}
+			}
+		}).detach();
+	}
+
+
+	void Print(Level a_level, const char* a_format, ...)
+	{
+		if (a_level > g_printLevel.load(std::memory_order_relaxed)) {
+			return;
+		}
+
+		auto time = Clock::now();
+		std::va_list args;
+		va_start(args, a_format);
+		if (g_async.load(std::memory_order_acquire)) {
+			if (!TryPush(time, a_format, args)) {
+				g_dropped.fetch_add(1, std::memory_order_relaxed);
+			}
+		} else {
+			char message[kMessageSize];
+			std::vsnprintf(message, kMessageSize, a_format, args);
+			std::lock_guard<std::mutex> locker(g_fileLock);
+			if (g_file) {
+				Write(time, message);
+				std::fflush(g_file);
+			}
+		}
+		va_end(args);
+	}
+
+
+	std::size_t GetDroppedCount()
+	{
+		return g_dropped;
+	}
+}
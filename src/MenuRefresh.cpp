@@ -0,0 +1,120 @@
+#include "MenuRefresh.h"
+
+#include "Metrics.h"  // ScopedTimer, Metric
+#include "Scheduler.h"  // AddTask, Priority
+#include "TaskPool.h"  // TaskPool
+
+#include "RE/Skyrim.h"
+
+
+namespace Menu
+{
+	InventoryMenuRefresh* InventoryMenuRefresh::GetSingleton()
+	{
+		static InventoryMenuRefresh singleton;
+		return &singleton;
+	}
+
+
+	void InventoryMenuRefresh::Request()
+	{
+		if (!_open) {
+			return;
+		}
+
+		if (!_pending.exchange(true)) {
+			Scheduler::AddTask(TaskPool<InventoryMenuRefreshDelegate>::Create(), Scheduler::Priority::kInterface);
+		}
+	}
+
+
+	void InventoryMenuRefresh::Run()
+	{
+		_pending = false;
+
+		std::lock_guard<std::mutex> locker(_menuLock);
+		if (!_open) {
+			return;
+		}
+
+		if (!_menu) {
+			auto ui = RE::UI::GetSingleton();
+			auto intStrings = RE::InterfaceStrings::GetSingleton();
+			_menu = ui->GetMenu<RE::InventoryMenu>(intStrings->inventoryMenu);
+		}
+
+		if (_menu && _menu->itemList) {
+			_menu->itemList->Update(RE::PlayerCharacter::GetSingleton());
+		}
+	}
+
+
+	void InventoryMenuRefresh::OnOpen()
+	{
+		std::lock_guard<std::mutex> locker(_menuLock);
+		auto ui = RE::UI::GetSingleton();
+		auto intStrings = RE::InterfaceStrings::GetSingleton();
+		_menu = ui->GetMenu<RE::InventoryMenu>(intStrings->inventoryMenu);
+		_open = true;
+	}
+
+
+	void InventoryMenuRefresh::OnClose()
+	{
+		std::lock_guard<std::mutex> locker(_menuLock);
+		_open = false;
+		_menu = nullptr;
+	}
+
+
+	InventoryMenuRefresh::InventoryMenuRefresh() :
+		_menuLock(),
+		_menu(nullptr),
+		_open(false),
+		_pending(false)
+	{}
+
+
+	void InventoryMenuRefreshDelegate::Run()
+	{
+		Metrics::ScopedTimer timer(Metrics::Metric::kMenuRefreshTask);
+
+		InventoryMenuRefresh::GetSingleton()->Run();
+	}
+
+
+	void InventoryMenuRefreshDelegate::Dispose()
+	{
+		TaskPool<InventoryMenuRefreshDelegate>::Release(this);
+	}
+
+
+	MenuOpenCloseEventHandler* MenuOpenCloseEventHandler::GetSingleton()
+	{
+		static MenuOpenCloseEventHandler singleton;
+		return &singleton;
+	}
+
+
+	auto MenuOpenCloseEventHandler::ProcessEvent(const RE::MenuOpenCloseEvent* a_event, RE::BSTEventSource<RE::MenuOpenCloseEvent>* a_eventSource)
+		-> EventResult
+	{
+		Metrics::ScopedTimer timer(Metrics::Metric::kMenuOpenCloseEvent);
+
+		if (!a_event) {
+			return EventResult::kContinue;
+		}
+
+		auto intStrings = RE::InterfaceStrings::GetSingleton();
+		if (a_event->menuName == intStrings->inventoryMenu) {
+			auto refresh = InventoryMenuRefresh::GetSingleton();
+			if (a_event->opening) {
+				refresh->OnOpen();
+			} else {
+				refresh->OnClose();
+			}
+		}
+
+		return EventResult::kContinue;
+	}
+}
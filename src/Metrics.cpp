@@ -0,0 +1,158 @@
+#include "Metrics.h"
+
+#include <chrono>  // duration_cast, minutes, steady_clock
+#include <iterator>  // size
+#include <thread>  // thread, sleep_for
+
+#include "RE/Skyrim.h"
+
+
+namespace Metrics
+{
+	namespace
+	{
+		constexpr const char* NAMES[] = {
+			"AnimationEvent",
+			"EquipEvent",
+			"ObjectLoadedEvent",
+			"ContainerChangedEvent",
+			"SwitchRaceEvent",
+			"MenuOpenCloseEvent",
+			"InventoryTaskBatch",
+			"DelayedWeaponTask",
+			"DelayedAmmoTask",
+			"DelayedHelmetLocator",
+			"AnimGraphSinkTask",
+			"MenuRefreshTask",
+			"InventoryVisit",
+			"SchedulerPump"
+		};
+		static_assert(std::size(NAMES) == static_cast<std::size_t>(Metric::kTotal));
+
+
+		constexpr auto kDumpInterval = std::chrono::minutes(5);
+
+
+		// Threads past kMaxThreads share the last block and fall back to atomic read-modify-writes
+		ThreadBlock g_blocks[kMaxThreads + 1];
+		std::atomic<std::size_t> g_numBlocks = 0;
+		thread_local ThreadBlock* t_block = 0;
+		thread_local bool t_shared = false;
+
+
+		ThreadBlock* GetThreadBlock()
+		{
+			if (!t_block) {
+				auto index = g_numBlocks.fetch_add(1);
+				if (index < kMaxThreads) {
+					t_block = &g_blocks[index];
+				} else {
+					t_block = &g_blocks[kMaxThreads];
+					t_shared = true;
+				}
+			}
+			return t_block;
+		}
+
+
+		void Bump(std::atomic<UInt64>& a_counter, UInt64 a_value)
+		{
+			if (t_shared) {
+				a_counter.fetch_add(a_value, std::memory_order_relaxed);
+			} else {
+				a_counter.store(a_counter.load(std::memory_order_relaxed) + a_value, std::memory_order_relaxed);
+			}
+		}
+
+
+		std::size_t GetBucket(UInt64 a_nanoseconds)
+		{
+			std::size_t bucket = 0;
+			while (a_nanoseconds > 1 && bucket < kNumBuckets - 1) {
+				a_nanoseconds >>= 1;
+				++bucket;
+			}
+			return bucket;
+		}
+
+
+		// Upper bound of the bucket holding the given percentile
+		UInt64 GetPercentile(const UInt64 (&a_buckets)[kNumBuckets], UInt64 a_count, double a_percentile)
+		{
+			auto rank = static_cast<UInt64>((a_count - 1) * a_percentile);
+			UInt64 seen = 0;
+			for (std::size_t i = 0; i < kNumBuckets; ++i) {
+				seen += a_buckets[i];
+				if (seen > rank) {
+					return UInt64(1) << (i + 1);
+				}
+			}
+			return UInt64(1) << kNumBuckets;
+		}
+	}
+
+
+	void Add(Metric a_metric, UInt64 a_nanoseconds)
+	{
+		auto& histogram = GetThreadBlock()->histograms[static_cast<std::size_t>(a_metric)];
+		Bump(histogram.count, 1);
+		Bump(histogram.totalNanoseconds, a_nanoseconds);
+		Bump(histogram.buckets[GetBucket(a_nanoseconds)], 1);
+	}
+
+
+	void Dump()
+	{
+		auto numBlocks = g_numBlocks.load();
+		numBlocks = numBlocks < kMaxThreads ? numBlocks : kMaxThreads + 1;
+
+		for (std::size_t metric = 0; metric < static_cast<std::size_t>(Metric::kTotal); ++metric) {
+			UInt64 count = 0;
+			UInt64 total = 0;
+			UInt64 buckets[kNumBuckets] = { 0 };
+			for (std::size_t i = 0; i < numBlocks; ++i) {
+				auto& histogram = g_blocks[i].histograms[metric];
+				count += histogram.count.load(std::memory_order_relaxed);
+				total += histogram.totalNanoseconds.load(std::memory_order_relaxed);
+				for (std::size_t j = 0; j < kNumBuckets; ++j) {
+					buckets[j] += histogram.buckets[j].load(std::memory_order_relaxed);
+				}
+			}
+
+			if (count != 0) {
+				_MESSAGE("%s: count (%llu), mean (%llu) ns, p50 (<%llu) ns, p99 (<%llu) ns, max (<%llu) ns",
+					NAMES[metric], count, total / count, GetPercentile(buckets, count, 0.50), GetPercentile(buckets, count, 0.99), GetPercentile(buckets, count, 1.0));
+			}
+		}
+	}
+
+
+	void StartPeriodicDump(void (*a_dump)())
+	{
+		static std::atomic<bool> started = false;
+		if (started.exchange(true)) {
+			return;
+		}
+
+		std::thread([a_dump]()
+		{
+			while (true) {
+				std::this_thread::sleep_for(kDumpInterval);
+				a_dump();
+			}
+		}).detach();
+	}
+
+
+	ScopedTimer::ScopedTimer(Metric a_metric) :
+		_metric(a_metric),
+		_start(std::chrono::steady_clock::now())
+	{}
+
+
+	ScopedTimer::~ScopedTimer()
+	{
+		auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count();
+		Add(_metric, static_cast<UInt64>(elapsed));
+	}
+}
@@ -0,0 +1,382 @@
+#include "PlayerInventory.h"
+
+#include <algorithm>  // find, lower_bound, sort
+#include <mutex>  // lock_guard
+
+#include "Metrics.h"  // ScopedTimer, Metric
+#include "Settings.h"  // Settings
+
+#include "RE/Skyrim.h"
+
+
+namespace Inventory
+{
+	PlayerInventory* PlayerInventory::GetSingleton()
+	{
+		static PlayerInventory singleton;
+		return &singleton;
+	}
+
+
+	void PlayerInventory::Visit(InventoryChangesVisitor* a_visitor)
+	{
+		Metrics::ScopedTimer timer(Metrics::Metric::kInventoryVisit);
+
+		std::lock_guard<std::mutex> locker(_indexLock);
+
+		auto player = RE::PlayerCharacter::GetSingleton();
+		if (_syncedGeneration != _generation || _changes != player->GetInventoryChanges()) {
+			Sync();
+		}
+
+		for (auto& entry : _index) {
+			if (entry.count > 0) {
+				entry.view.extraLists = entry.changes ? entry.changes->extraLists : 0;
+				if (!a_visitor->Accept(&entry.view, entry.count)) {
+					break;
+				}
+			}
+		}
+	}
+
+
+	void PlayerInventory::Invalidate()
+	{
+		std::lock_guard<std::mutex> locker(_pendingLock);
+		_rebuild = true;
+		_pending.clear();
+		++_generation;
+	}
+
+
+	void PlayerInventory::Invalidate(FormID a_formID)
+	{
+		std::lock_guard<std::mutex> locker(_pendingLock);
+		if (!_rebuild) {
+			if (_pending.size() >= kMaxPending) {
+				_rebuild = true;
+				_pending.clear();
+			} else if (std::find(_pending.begin(), _pending.end(), a_formID) == _pending.end()) {
+				_pending.push_back(a_formID);
+			}
+		}
+		++_generation;
+	}
+
+
+	PlayerInventory::PlayerInventory() :
+		_indexLock(),
+		_index(),
+		_changes(0),
+		_syncedGeneration(0),
+		_work(),
+		_refreshed(),
+		_pendingLock(),
+		_pending(),
+		_rebuild(true),
+		_generation(1)
+	{
+		_work.reserve(kMaxPending);
+		_refreshed.reserve(kMaxPending);
+		_pending.reserve(kMaxPending);
+	}
+
+
+	void PlayerInventory::Sync()
+	{
+		auto player = RE::PlayerCharacter::GetSingleton();
+		auto changes = player->GetInventoryChanges();
+
+		bool rebuild;
+		UInt32 generation;
+		{
+			std::lock_guard<std::mutex> locker(_pendingLock);
+			rebuild = _rebuild;
+			_rebuild = false;
+			_work.swap(_pending);
+			generation = _generation;
+		}
+
+		if (rebuild || _changes != changes) {
+			_changes = changes;
+			Rebuild();
+		} else if (!_work.empty()) {
+			Refresh();
+		}
+
+		_work.clear();
+		_syncedGeneration = generation;
+	}
+
+
+	void PlayerInventory::Rebuild()
+	{
+		_index.clear();
+
+		if (_changes && _changes->entryList) {
+			for (auto& entry : *_changes->entryList) {
+				if (entry && entry->object) {
+					_index.push_back({ entry->object->formID, { entry->object, 0 }, entry->countDelta, entry });
+				}
+			}
+		}
+
+		auto byFormID = [](const Entry& a_lhs, const Entry& a_rhs) -> bool
+		{
+			return a_lhs.formID < a_rhs.formID;
+		};
+		std::sort(_index.begin(), _index.end(), byFormID);
+
+		// Items without changes are appended past the sorted range, then merged back in
+		auto numChanges = _index.size();
+		auto player = RE::PlayerCharacter::GetSingleton();
+		auto container = player->GetContainer();
+		if (container) {
+			container->ForEachContainerObject([&](RE::ContainerObject* a_entry) -> bool
+			{
+				if (a_entry->obj) {
+					auto end = _index.begin() + numChanges;
+					auto it = std::lower_bound(_index.begin(), end, a_entry->obj->formID, [](const Entry& a_lhs, FormID a_rhs) -> bool
+					{
+						return a_lhs.formID < a_rhs;
+					});
+					if (it != end && it->formID == a_entry->obj->formID) {
+						if (!a_entry->obj->IsGold()) {
+							it->count += a_entry->count;
+						}
+					} else {
+						_index.push_back({ a_entry->obj->formID, { a_entry->obj, 0 }, a_entry->count, 0 });
+					}
+				}
+				return true;
+			});
+		}
+
+		if (_index.size() == numChanges) {
+			return;
+		}
+
+		std::sort(_index.begin(), _index.end(), byFormID);
+
+		std::size_t kept = 0;
+		for (std::size_t i = 0; i < _index.size(); ++i) {
+			if (kept != 0 && _index[kept - 1].formID == _index[i].formID) {
+				if (!_index[i].view.object->IsGold()) {
+					_index[kept - 1].count += _index[i].count;
+				}
+			} else {
+				_index[kept++] = _index[i];
+			}
+		}
+		_index.resize(kept);
+	}
+
+
+	// Merges every pending form from one walk of the changes and one walk of the base container, matching entries against the sorted work list
+	void PlayerInventory::Refresh()
+	{
+		std::sort(_work.begin(), _work.end());
+		_refreshed.clear();
+		for (auto& formID : _work) {
+			_refreshed.push_back({ formID, { 0, 0 }, 0, 0 });
+		}
+
+		auto lookup = [&](FormID a_formID) -> Entry*
+		{
+			auto it = std::lower_bound(_work.begin(), _work.end(), a_formID);
+			return it != _work.end() && *it == a_formID ? &_refreshed[it - _work.begin()] : 0;
+		};
+
+		if (_changes && _changes->entryList) {
+			for (auto& entry : *_changes->entryList) {
+				if (entry && entry->object) {
+					auto merged = lookup(entry->object->formID);
+					if (merged && !merged->view.object) {
+						merged->view = { entry->object, 0 };
+						merged->count = entry->countDelta;
+						merged->changes = entry;
+					}
+				}
+			}
+		}
+
+		auto player = RE::PlayerCharacter::GetSingleton();
+		auto container = player->GetContainer();
+		if (container) {
+			container->ForEachContainerObject([&](RE::ContainerObject* a_entry) -> bool
+			{
+				if (a_entry->obj) {
+					auto merged = lookup(a_entry->obj->formID);
+					if (merged) {
+						if (!merged->view.object) {
+							merged->view = { a_entry->obj, 0 };
+							merged->count = a_entry->count;
+						} else if (!a_entry->obj->IsGold()) {
+							merged->count += a_entry->count;
+						}
+					}
+				}
+				return true;
+			});
+		}
+
+		for (auto& merged : _refreshed) {
+			auto it = Find(merged.formID);
+			bool exists = it != _index.end() && it->formID == merged.formID;
+			if (merged.view.object) {
+				if (exists) {
+					*it = merged;
+				} else {
+					_index.insert(it, merged);
+				}
+			} else if (exists) {
+				_index.erase(it);
+			}
+		}
+	}
+
+
+	auto PlayerInventory::Find(FormID a_formID)
+		-> Index::iterator
+	{
+		return std::lower_bound(_index.begin(), _index.end(), a_formID, [](const Entry& a_lhs, FormID a_rhs) -> bool
+		{
+			return a_lhs.formID < a_rhs;
+		});
+	}
+
+
+	AmmoCounts* AmmoCounts::GetSingleton()
+	{
+		static AmmoCounts singleton;
+		return &singleton;
+	}
+
+
+	Count AmmoCounts::GetCount(FormID a_formID)
+	{
+		std::lock_guard<std::mutex> locker(_lock);
+		if (_rebuild) {
+			Rebuild();
+		}
+#if _DEBUG
+		else {
+			Validate();
+		}
+#endif
+
+		auto it = _counts.find(a_formID);
+		return it != _counts.end() ? it->second : 0;
+	}
+
+
+	void AmmoCounts::Apply(FormID a_formID, Count a_delta)
+	{
+		std::lock_guard<std::mutex> locker(_lock);
+		if (_rebuild) {
+			return;
+		}
+
+		auto& count = _counts[a_formID];
+		count += a_delta;
+		if (count <= 0) {
+			_counts.erase(a_formID);
+		}
+	}
+
+
+	void AmmoCounts::Invalidate()
+	{
+		std::lock_guard<std::mutex> locker(_lock);
+		_rebuild = true;
+	}
+
+
+	AmmoCounts::Visitor::Visitor(std::unordered_map<FormID, Count>& a_counts) :
+		_counts(a_counts)
+	{}
+
+
+	bool AmmoCounts::Visitor::Accept(InventoryEntryView* a_entry, SInt32 a_count)
+	{
+		if (a_entry->object->IsAmmo()) {
+			_counts[a_entry->object->formID] = a_count;
+		}
+		return true;
+	}
+
+
+	AmmoCounts::AmmoCounts() :
+		_lock(),
+		_counts(),
+		_rebuild(true)
+	{}
+
+
+	void AmmoCounts::Rebuild()
+	{
+		_counts.clear();
+		Visitor visitor(_counts);
+		PlayerInventory::GetSingleton()->Visit(&visitor);
+		_rebuild = false;
+	}
+
+
+#if _DEBUG
+	void AmmoCounts::Validate()
+	{
+		std::unordered_map<FormID, Count> scanned;
+		Visitor visitor(scanned);
+		PlayerInventory::GetSingleton()->Visit(&visitor);
+
+		if (scanned != _counts) {
+			for (auto& entry : scanned) {
+				auto it = _counts.find(entry.first);
+				auto count = it != _counts.end() ? it->second : 0;
+				if (count != entry.second) {
+					_ERROR("Ammo count for (%08X) is out of date! Read (%i), expected (%i)", entry.first, count, entry.second);
+				}
+			}
+			if (scanned.size() != _counts.size()) {
+				_ERROR("Ammo count table holds (%zu) entries, expected (%zu)", _counts.size(), scanned.size());
+			}
+			_counts.swap(scanned);
+		}
+	}
+#endif
+
+
+	TESContainerChangedEventHandler* TESContainerChangedEventHandler::GetSingleton()
+	{
+		static TESContainerChangedEventHandler singleton;
+		return &singleton;
+	}
+
+
+	auto TESContainerChangedEventHandler::ProcessEvent(const RE::TESContainerChangedEvent* a_event, RE::BSTEventSource<RE::TESContainerChangedEvent>* a_eventSource)
+		-> EventResult
+	{
+		Metrics::ScopedTimer timer(Metrics::Metric::kContainerChangedEvent);
+
+		if (!a_event) {
+			return EventResult::kContinue;
+		}
+
+		auto player = RE::PlayerCharacter::GetSingleton();
+		bool removed = a_event->oldContainer == player->formID;
+		bool added = a_event->newContainer == player->formID;
+		if (removed || added) {
+			_DMESSAGE("Player inventory changed for (%08X), count (%d)", a_event->baseObj, added ? a_event->itemCount : -a_event->itemCount);
+			PlayerInventory::GetSingleton()->Invalidate(a_event->baseObj);
+
+			if (Settings::manageAmmo && removed != added) {
+				auto form = RE::TESForm::LookupByID(a_event->baseObj);
+				if (form && form->IsAmmo()) {
+					AmmoCounts::GetSingleton()->Apply(a_event->baseObj, added ? a_event->itemCount : -a_event->itemCount);
+				}
+			}
+		}
+
+		return EventResult::kContinue;
+	}
+}
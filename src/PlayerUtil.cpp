@@ -2,60 +2,230 @@
 
 #include "skse64/PluginAPI.h"  // SKSETaskInterface
 
-#include <utility>  // pair, make_pair
-#include <map>  // map
+#include <atomic>  // atomic
+#include <mutex>  // mutex, lock_guard
 #include <vector>  // vector
 
 #include "Forms.h"  // WerewolfBeastRace, DLC1VampireBeastRace
+#include "Metrics.h"  // ScopedTimer, Metric
+#include "PlayerInventory.h"  // PlayerInventory
+#include "Scheduler.h"  // AddTask, Priority
+#include "TaskPool.h"  // TaskPool
+#include "Trace.h"  // IsReplaying
 
 #include "RE/Skyrim.h"
 
 
-void VisitPlayerInventoryChanges(InventoryChangesVisitor* a_visitor)
+namespace
 {
-	auto player = RE::PlayerCharacter::GetSingleton();
-	auto changes = player->GetInventoryChanges();
-	std::map<FormID, std::pair<RE::InventoryEntryData*, Count>> invMap;
-	if (changes) {
-		for (auto& entry : *changes->entryList) {
-			if (entry && entry->object) {
-				invMap.emplace(entry->object->formID, std::make_pair(entry, entry->countDelta));
+	std::atomic<bool> g_isBeastRace = false;
+
+
+	class InventoryTaskBatch : public TaskDelegate
+	{
+	public:
+		static void Queue(InventoryTaskDelegate* a_task)
+		{
+			std::lock_guard<std::mutex> locker(_lock);
+			_pending.push_back(a_task);
+			if (!_queued) {
+				_queued = true;
+				Scheduler::AddTask(TaskPool<InventoryTaskBatch>::Create(), Scheduler::Priority::kEquip);
 			}
 		}
-	}
 
-	auto container = player->GetContainer();
-	std::vector<RE::InventoryEntryData*> heapList;
-	if (container) {
-		container->ForEachContainerObject([&](RE::ContainerObject* a_entry) -> bool
+
+		virtual void Run() override
 		{
-			if (a_entry->obj) {
-				auto& it = invMap.find(a_entry->obj->formID);
-				if (it != invMap.end()) {
-					if (!a_entry->obj->IsGold()) {
-						it->second.second += a_entry->count;
+			Metrics::ScopedTimer timer(Metrics::Metric::kInventoryTaskBatch);
+
+			{
+				std::lock_guard<std::mutex> locker(_lock);
+				_running.swap(_pending);
+				_queued = false;
+			}
+
+			for (auto& task : _running) {
+				task->UnEquip();
+			}
+
+			CompositeInventoryChangesVisitor composite;
+			for (auto& task : _running) {
+				auto visitor = task->Prepare();
+				if (visitor) {
+					if (composite.Full()) {
+						VisitPlayerInventoryChanges(&composite);
+						composite.Clear();
 					}
-				} else {
-					RE::InventoryEntryData* entryData = new RE::InventoryEntryData(a_entry->obj, a_entry->count);
-					heapList.push_back(entryData);
-					invMap.emplace(a_entry->obj->formID, std::make_pair(entryData, entryData->countDelta));
+					composite.Add(visitor);
 				}
 			}
-			return true;
-		});
-	}
 
-	for (auto& item : invMap) {
-		if (item.second.second > 0) {
-			if (!a_visitor->Accept(item.second.first, item.second.second)) {
-				break;
+			if (!composite.Empty()) {
+				VisitPlayerInventoryChanges(&composite);
+			}
+
+			for (auto& task : _running) {
+				task->Finish();
+				task->Dispose();
 			}
+			_running.clear();
+		}
+
+
+		virtual void Dispose() override
+		{
+			TaskPool<InventoryTaskBatch>::Release(this);
+		}
+
+	private:
+		static inline std::mutex _lock;
+		static inline std::vector<InventoryTaskDelegate*> _pending;
+		static inline std::vector<InventoryTaskDelegate*> _running;
+		static inline bool _queued = false;
+	};
+}
+
+
+CompositeInventoryChangesVisitor::CompositeInventoryChangesVisitor() :
+	_visitors{ 0 },
+	_size(0)
+{}
+
+
+bool CompositeInventoryChangesVisitor::Accept(InventoryEntryView* a_entry, SInt32 a_count)
+{
+	std::size_t kept = 0;
+	for (std::size_t i = 0; i < _size; ++i) {
+		if (_visitors[i]->Accept(a_entry, a_count)) {
+			_visitors[kept++] = _visitors[i];
 		}
 	}
+	_size = kept;
+	return _size != 0;
+}
+
+
+bool CompositeInventoryChangesVisitor::Add(InventoryChangesVisitor* a_visitor)
+{
+	if (Full()) {
+		return false;
+	}
+
+	_visitors[_size++] = a_visitor;
+	return true;
+}
+
+
+void CompositeInventoryChangesVisitor::Clear()
+{
+	_size = 0;
+}
+
+
+bool CompositeInventoryChangesVisitor::Empty() const
+{
+	return _size == 0;
+}
+
+
+bool CompositeInventoryChangesVisitor::Full() const
+{
+	return _size == kCapacity;
+}
+
+
+void InventoryTaskDelegate::Run()
+{
+	UnEquip();
+	auto visitor = Prepare();
+	if (visitor) {
+		VisitPlayerInventoryChanges(visitor);
+	}
+	Finish();
+}
+
+
+void InventoryTaskDelegate::UnEquip()
+{}
+
+
+void InventoryTaskDelegate::Finish()
+{}
+
+
+EquipIntent::EquipIntent() :
+	_state(State::kNone),
+	_dropped(0)
+{}
+
+
+bool EquipIntent::Post(bool a_equip)
+{
+	auto prev = _state.exchange(a_equip ? State::kEquip : State::kUnEquip);
+	if (prev != State::kNone) {
+		++_dropped;
+		return false;
+	} else {
+		return true;
+	}
+}
+
+
+auto EquipIntent::Take()
+	-> State
+{
+	return _state.exchange(State::kNone);
+}
+
+
+std::size_t EquipIntent::GetDroppedCount() const
+{
+	return _dropped;
+}
+
+
+void VisitPlayerInventoryChanges(InventoryChangesVisitor* a_visitor)
+{
+	Inventory::PlayerInventory::GetSingleton()->Visit(a_visitor);
+}
+
+
+void QueueInventoryTask(InventoryTaskDelegate* a_task)
+{
+	InventoryTaskBatch::Queue(a_task);
+}
+
+
+std::size_t GetInventoryTaskOverflowCount()
+{
+	return TaskPool<InventoryTaskBatch>::GetOverflowCount();
+}
+
+
+// Every equip change the plugin makes on the player goes through these two calls
+// A trace replay only exercises the plugin's own state, so they leave the player's equipment alone while it runs
+void EquipPlayerItem(RE::TESBoundObject* a_item, RE::ExtraDataList* a_xList, UInt32 a_count, RE::BGSEquipSlot* a_slot)
+{
+	if (Trace::IsReplaying()) {
+		return;
+	}
+
+	auto equipManager = RE::ActorEquipManager::GetSingleton();
+	auto player = RE::PlayerCharacter::GetSingleton();
+	equipManager->EquipItem(player, a_item, a_xList, a_count, a_slot, true, false, false);
+}
+
 
-	for (auto& entry : heapList) {
-		delete entry;
+void UnEquipPlayerItem(RE::TESBoundObject* a_item, RE::ExtraDataList* a_xList, UInt32 a_count, RE::BGSEquipSlot* a_slot)
+{
+	if (Trace::IsReplaying()) {
+		return;
 	}
+
+	auto equipManager = RE::ActorEquipManager::GetSingleton();
+	auto player = RE::PlayerCharacter::GetSingleton();
+	equipManager->UnequipItem(player, a_item, a_xList, a_count, a_slot, true, false);
 }
 
 
@@ -87,9 +257,16 @@ bool SinkAnimationGraphEventHandler(RE::BSTEventSink<RE::BSAnimationGraphEvent>*
 }
 
 
+// Cached by UpdatePlayerBeastRace, which runs on load and whenever the player switches race
 bool PlayerIsBeastRace()
+{
+	return g_isBeastRace;
+}
+
+
+void UpdatePlayerBeastRace()
 {
 	auto player = RE::PlayerCharacter::GetSingleton();
 	auto race = player->GetRace();
-	return race == WerewolfBeastRace || race == DLC1VampireBeastRace;
+	g_isBeastRace = race && (race == WerewolfBeastRace || race == DLC1VampireBeastRace);
 }
@@ -0,0 +1,175 @@
+#include "Scheduler.h"
+
+#include "skse64_common/SafeWrite.h"  // SafeWrite64
+
+#include <atomic>  // atomic
+#include <chrono>  // microseconds, steady_clock
+#include <deque>  // deque
+#include <mutex>  // mutex, lock_guard
+#include <typeinfo>  // typeid
+
+#include "Metrics.h"  // ScopedTimer, Metric
+#include "Settings.h"  // Settings
+#include "TaskPool.h"  // TaskPool
+
+#include "RE/Skyrim.h"
+#include "REL/Relocation.h"
+#include "SKSE/API.h"
+
+
+namespace Scheduler
+{
+	namespace
+	{
+		using Clock = std::chrono::steady_clock;
+
+
+		// SKSE runs tasks queued during its task loop in that same loop, so a pump that defers work leaves it to the next player update to queue the pump again
+		// Equip and interface work queued in between still gets a pump right away, which also picks up deferred work within the budget
+		class PumpTaskDelegate : public TaskDelegate
+		{
+		public:
+			static void Queue(TaskDelegate* a_task, Priority a_priority)
+			{
+				std::lock_guard<std::mutex> locker(_lock);
+				_queues[static_cast<std::size_t>(a_priority)].push_back(a_task);
+				if (!_queued && (!_deferring || a_priority != Priority::kBookkeeping)) {
+					_queued = true;
+					SKSE::GetTaskInterface()->AddTask(TaskPool<PumpTaskDelegate>::Create());
+				}
+			}
+
+
+			// Called once per frame from the player's update, so deferred work resumes on the frame after the one that deferred it, whatever its length
+			static void Resume()
+			{
+				if (!_deferring) {
+					return;
+				}
+
+				std::lock_guard<std::mutex> locker(_lock);
+				_deferring = false;
+				if (!_queued) {
+					_queued = true;
+					SKSE::GetTaskInterface()->AddTask(TaskPool<PumpTaskDelegate>::Create());
+				}
+			}
+
+
+			virtual void Run() override
+			{
+				Metrics::ScopedTimer timer(Metrics::Metric::kSchedulerPump);
+
+				auto start = Clock::now();
+				while (RunNext(Priority::kEquip) || RunNext(Priority::kInterface)) {}
+
+				auto budget = std::chrono::microseconds(static_cast<int>(Settings::taskBudget));
+				bool ranAny = false;
+				while (!ranAny || Clock::now() - start < budget) {
+					if (!RunNext(Priority::kBookkeeping)) {
+						break;
+					}
+					ranAny = true;
+				}
+
+				std::lock_guard<std::mutex> locker(_lock);
+				_deferring = false;
+				if (!_queues[static_cast<std::size_t>(Priority::kEquip)].empty() || !_queues[static_cast<std::size_t>(Priority::kInterface)].empty()) {
+					SKSE::GetTaskInterface()->AddTask(TaskPool<PumpTaskDelegate>::Create());
+				} else if (!_queues[static_cast<std::size_t>(Priority::kBookkeeping)].empty()) {
+					++_deferred;
+					_deferring = true;
+					_queued = false;
+				} else {
+					_queued = false;
+				}
+			}
+
+
+			virtual void Dispose() override
+			{
+				TaskPool<PumpTaskDelegate>::Release(this);
+			}
+
+
+			static std::size_t GetDeferredCount()
+			{
+				return _deferred;
+			}
+
+		private:
+			static bool RunNext(Priority a_priority)
+			{
+				TaskDelegate* task = 0;
+				{
+					std::lock_guard<std::mutex> locker(_lock);
+					auto& queue = _queues[static_cast<std::size_t>(a_priority)];
+					if (queue.empty()) {
+						return false;
+					}
+					task = queue.front();
+					queue.pop_front();
+				}
+
+				task->Run();
+				task->Dispose();
+				return true;
+			}
+
+
+			static inline std::mutex _lock;
+			static inline std::deque<TaskDelegate*> _queues[static_cast<std::size_t>(Priority::kTotal)];
+			static inline bool _queued = false;
+			static inline std::atomic<bool> _deferring = false;
+			static inline std::atomic<std::size_t> _deferred = 0;
+		};
+
+
+		class PlayerCharacterEx : public RE::PlayerCharacter
+		{
+		public:
+			using func_t = function_type_t<decltype(&RE::PlayerCharacter::Update)>;
+			inline static func_t* func = 0;
+
+
+			void Hook_Update(float a_delta)
+			{
+				func(this, a_delta);
+				PumpTaskDelegate::Resume();
+			}
+
+
+			static void InstallHooks()
+			{
+				REL::Offset<func_t**> vFunc(RE::Offset::PlayerCharacter::Vtbl + (0xAD * 0x8));
+				func = *vFunc;
+				SafeWrite64(vFunc.GetAddress(), GetFnAddr(&PlayerCharacterEx::Hook_Update));
+				_DMESSAGE("Installed hooks for (%s)", typeid(PlayerCharacterEx).name());
+			}
+		};
+	}
+
+
+	void InstallHooks()
+	{
+		PlayerCharacterEx::InstallHooks();
+	}
+
+
+	void AddTask(TaskDelegate* a_task, Priority a_priority)
+	{
+		PumpTaskDelegate::Queue(a_task, a_priority);
+	}
+
+
+	std::size_t GetDeferredCount()
+	{
+		return PumpTaskDelegate::GetDeferredCount();
+	}
+
+
+	std::size_t GetPumpOverflowCount()
+	{
+		return TaskPool<PumpTaskDelegate>::GetOverflowCount();
+	}
+}
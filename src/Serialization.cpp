@@ -0,0 +1,200 @@
+#include "Serialization.h"
+
+#include <algorithm>  // min
+#include <cstring>  // memcpy
+#include <string>  // string
+#include <vector>  // vector
+
+#include "Ammo.h"  // Ammo
+#include "ISerializableForm.h"  // SlotRecord, kInvalid
+#include "ManagedSlots.h"  // ManagedSlots
+
+#include "SKSE/Interfaces.h"
+
+
+namespace Serialization
+{
+	namespace
+	{
+		enum : UInt32
+		{
+			kVersion = 4,
+			kLegacyVersion = 3,
+			kEquipment = 'EQPM',
+			kAmmo = 'AMMO'
+		};
+
+
+		struct Header
+		{
+			UInt32 recordSize;
+			UInt32 numRecords;
+		};
+		static_assert(sizeof(Header) == 8);
+
+
+		// Version 3 wrote one record per slot, holding the formID, then for helmets the enchantment formID and, in later builds, the health
+		// Both helmet layouts share version 3, so they are told apart by the record length rather than the version
+		// A missing health reads as 0, which the helmet treats as matching any health
+		struct LegacyRecord
+		{
+			UInt32 formID;
+			UInt32 enchantment;
+			float health;
+		};
+
+
+		std::string DecodeTypeCode(UInt32 a_typeCode)
+		{
+			constexpr std::size_t SIZE = sizeof(UInt32);
+
+			std::string sig;
+			sig.resize(SIZE);
+			char* iter = reinterpret_cast<char*>(&a_typeCode);
+			for (std::size_t i = 0, j = SIZE - 2; i < SIZE - 1; ++i, --j) {
+				sig[j] = iter[i];
+			}
+			return sig;
+		}
+
+
+		// Entries written with a smaller record size keep the defaults for the fields they lack, and fields appended by later versions are skipped
+		bool ReadRecords(SKSE::SerializationInterface* a_intfc, UInt32 a_length, std::vector<SlotRecord>& a_records)
+		{
+			Header header;
+			if (a_length < sizeof(header) || a_intfc->ReadRecordData(&header, sizeof(header)) != sizeof(header)) {
+				return false;
+			}
+
+			auto size = static_cast<UInt64>(header.recordSize) * header.numRecords;
+			if (header.recordSize < sizeof(UInt32) * 2 || a_length - sizeof(header) != size) {
+				return false;
+			}
+
+			std::vector<UInt8> buffer(static_cast<std::size_t>(size));
+			if (size != 0 && a_intfc->ReadRecordData(buffer.data(), static_cast<UInt32>(size)) != size) {
+				return false;
+			}
+
+			auto copySize = std::min<std::size_t>(header.recordSize, sizeof(SlotRecord));
+			for (UInt32 i = 0; i < header.numRecords; ++i) {
+				SlotRecord record = { 0, kInvalid, kInvalid, 0.0F };
+				std::memcpy(&record, buffer.data() + i * header.recordSize, copySize);
+				a_records.push_back(record);
+			}
+			return true;
+		}
+
+
+		bool ReadLegacyRecord(SKSE::SerializationInterface* a_intfc, UInt32 a_type, UInt32 a_length, std::vector<SlotRecord>& a_records)
+		{
+			LegacyRecord legacy = { kInvalid, kInvalid, 0.0F };
+			auto size = std::min<UInt32>(a_length, sizeof(legacy));
+			if (size < sizeof(legacy.formID) || a_intfc->ReadRecordData(&legacy, size) != size) {
+				return false;
+			}
+
+			a_records.push_back({ a_type, legacy.formID, legacy.enchantment, legacy.health });
+			return true;
+		}
+
+
+		bool ResolveFormID(SKSE::SerializationInterface* a_intfc, UInt32& a_formID)
+		{
+			return a_formID == kInvalid || a_intfc->ResolveFormID(a_formID, a_formID);
+		}
+
+
+		// An entry with any form that no longer resolves is dropped as a whole, so no instance loads half resolved
+		void ResolveForms(SKSE::SerializationInterface* a_intfc, std::vector<SlotRecord>& a_records)
+		{
+			for (auto& record : a_records) {
+				if (!ResolveFormID(a_intfc, record.formID) || !ResolveFormID(a_intfc, record.enchantment)) {
+					_ERROR("Failed to resolve formID for type code (%s)", DecodeTypeCode(record.type).c_str());
+					record.formID = kInvalid;
+				}
+			}
+		}
+
+
+		void Apply(const std::vector<SlotRecord>& a_records)
+		{
+			for (auto& record : a_records) {
+				if (record.formID == kInvalid) {
+					continue;
+				}
+
+				if (record.type == kAmmo) {
+					Ammo::Ammo::GetSingleton()->Load(record);
+				} else if (!ManagedSlots::Load(record)) {
+					_ERROR("Unrecognized record type (%s)!", DecodeTypeCode(record.type).c_str());
+				}
+			}
+		}
+	}
+
+
+	bool Save(SKSE::SerializationInterface* a_intfc)
+	{
+		std::vector<SlotRecord> records;
+		Snapshot(records);
+
+		Header header = { sizeof(SlotRecord), static_cast<UInt32>(records.size()) };
+		if (!a_intfc->OpenRecord(kEquipment, kVersion)) {
+			_ERROR("Failed to open serialization record!\n");
+			return false;
+		}
+
+		a_intfc->WriteRecordData(&header, sizeof(header));
+		if (!records.empty()) {
+			a_intfc->WriteRecordData(records.data(), static_cast<UInt32>(records.size() * sizeof(SlotRecord)));
+		}
+		return true;
+	}
+
+
+	void Load(SKSE::SerializationInterface* a_intfc)
+	{
+		std::vector<SlotRecord> records;
+		UInt32 type;
+		UInt32 version;
+		UInt32 length;
+		while (a_intfc->GetNextRecordInfo(type, version, length)) {
+			if (type == kEquipment && version >= kVersion) {
+				if (!ReadRecords(a_intfc, length, records)) {
+					_ERROR("Failed to read record (%s)!\n", DecodeTypeCode(type).c_str());
+				}
+			} else if (type != kEquipment && version == kLegacyVersion) {
+				if (ReadLegacyRecord(a_intfc, type, length, records)) {
+					_MESSAGE("Migrated record (%s) from version (%u)", DecodeTypeCode(type).c_str(), version);
+				} else {
+					_ERROR("Failed to read record (%s)!\n", DecodeTypeCode(type).c_str());
+				}
+			} else {
+				_ERROR("Loaded data is out of date! Read (%u), expected (%u) for type code (%s)", version, kVersion, DecodeTypeCode(type).c_str());
+			}
+		}
+
+		ResolveForms(a_intfc, records);
+		Apply(records);
+	}
+
+
+	void Snapshot(std::vector<SlotRecord>& a_records)
+	{
+		SlotRecord ammo = { kAmmo };
+		Ammo::Ammo::GetSingleton()->Save(ammo);
+		if (ammo.formID != kInvalid) {
+			a_records.push_back(ammo);
+		}
+		ManagedSlots::Save(a_records);
+	}
+
+
+	void Restore(const std::vector<SlotRecord>& a_records)
+	{
+		Ammo::Ammo::GetSingleton()->Clear();
+		ManagedSlots::Clear();
+		Apply(a_records);
+	}
+}
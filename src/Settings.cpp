@@ -1,4 +1,4 @@
-#include "settings.h"
+#include "Settings.h"
 
 
 bool Settings::loadSettings(bool a_dumpParse)
@@ -10,3 +10,6 @@ bool Settings::loadSettings(bool a_dumpParse)
 decltype(Settings::manageAmmo)		Settings::manageAmmo("manageAmmo", true);
 decltype(Settings::manageHelmet)	Settings::manageHelmet("manageHelmet", true);
 decltype(Settings::manageShield)	Settings::manageShield("manageShield", true);
+decltype(Settings::recordEventTrace)	Settings::recordEventTrace("recordEventTrace", false);
+decltype(Settings::replayEventTrace)	Settings::replayEventTrace("replayEventTrace", false);
+decltype(Settings::taskBudget)		Settings::taskBudget("taskBudget", 2000);
@@ -5,8 +5,6 @@
 
 #include <type_traits>  // typeid
 
-#include "Animations.h"  // Anim, HashAnimation
-#include "PlayerUtil.h"  // PlayerIsBeastRace
 #include "Settings.h"  // Settings
 
 #include "RE/Skyrim.h"
@@ -16,6 +14,12 @@
 
 namespace Shield
 {
+	namespace
+	{
+		bool g_skipAnim = false;
+	}
+
+
 	Shield* Shield::GetSingleton()
 	{
 		static Shield singleton;
@@ -29,156 +33,66 @@ namespace Shield
 	}
 
 
-	ShieldTaskDelegate::ShieldTaskDelegate(bool a_equip) :
-		_equip(a_equip)
-	{}
-
-
-	void ShieldTaskDelegate::Run()
-	{
-		if (_equip) {
-			auto player = RE::PlayerCharacter::GetSingleton();
-			if (!player->currentProcess->GetEquippedLeftHand()) {
-				ShieldEquipVisitor visitor;
-				VisitPlayerInventoryChanges(&visitor);
-			}
-		} else {
-			ShieldUnEquipVisitor visitor;
-			VisitPlayerInventoryChanges(&visitor);
-		}
-	}
-
-
-	void ShieldTaskDelegate::Dispose()
+	bool ShieldPolicy::Enabled()
 	{
-		delete this;
+		return Settings::manageShield;
 	}
 
 
-	bool ShieldTaskDelegate::ShieldEquipVisitor::Accept(RE::InventoryEntryData* a_entry, SInt32 a_count)
+	bool ShieldPolicy::CanEquip()
 	{
-		if (a_entry->object->formID == Shield::GetSingleton()->GetFormID()) {
-			g_skipAnim = true;
-			auto shield = static_cast<RE::TESObjectARMO*>(a_entry->object);
-			auto equipManager = RE::ActorEquipManager::GetSingleton();
-			auto player = RE::PlayerCharacter::GetSingleton();
-			auto xList = (a_entry->extraLists && !a_entry->extraLists->empty()) ? a_entry->extraLists->front() : 0;
-			equipManager->EquipItem(player, shield, xList, 1, shield->equipSlot, true, false, false);
-			return false;
-		}
-		return true;
+		auto player = RE::PlayerCharacter::GetSingleton();
+		return !player->currentProcess->GetEquippedLeftHand();
 	}
 
 
-	bool ShieldTaskDelegate::ShieldUnEquipVisitor::Accept(RE::InventoryEntryData* a_entry, SInt32 a_count)
+	void ShieldPolicy::OnBeforeEquip()
 	{
-		using FirstPersonFlag = RE::BIPED_MODEL::BipedObjectSlot;
-
-		if (a_entry->object->formID == Shield::GetSingleton()->GetFormID()) {
-			if (a_entry->extraLists) {
-				for (auto& xList : *a_entry->extraLists) {
-					if (xList->HasType(RE::ExtraDataType::kWorn)) {
-						auto armor = static_cast<RE::TESObjectARMO*>(a_entry->object);
-						if (armor->HasPartOf(FirstPersonFlag::kShield)) {
-							auto equipManager = RE::ActorEquipManager::GetSingleton();
-							auto player = RE::PlayerCharacter::GetSingleton();
-							equipManager->UnequipItem(player, armor, xList, 1, armor->equipSlot, true, false);
-							return false;
-						}
-					}
-				}
-			}
-		}
-		return true;
+		g_skipAnim = true;
 	}
 
 
-	void AnimGraphSinkDelegate::Run()
+	void ShieldPolicy::OnTailCombatIdle()
 	{
-		SinkAnimationGraphEventHandler(BSAnimationGraphEventHandler::GetSingleton());
+		g_skipAnim = false;
 	}
 
 
-	void AnimGraphSinkDelegate::Dispose()
+	bool ShieldPolicy::IsRemembered(InventoryEntryView* a_entry, SInt32 a_count, RE::ExtraDataList*& a_xList)
 	{
-		delete this;
-	}
-
+		if (a_entry->object->formID != Shield::GetSingleton()->GetFormID()) {
+			return false;
+		}
 
-	TESEquipEventHandler* TESEquipEventHandler::GetSingleton()
-	{
-		static TESEquipEventHandler singleton;
-		return &singleton;
+		a_xList = (a_entry->extraLists && !a_entry->extraLists->empty()) ? a_entry->extraLists->front() : 0;
+		return true;
 	}
 
 
-	auto TESEquipEventHandler::ProcessEvent(const RE::TESEquipEvent* a_event, RE::BSTEventSource<RE::TESEquipEvent>* a_eventSource)
-		-> EventResult
+	// Only the shield's form is remembered, so any copy of it counts
+	bool ShieldPolicy::IsRememberedInstance(const ItemFingerprint& a_instance)
 	{
-		using FirstPersonFlag = RE::BIPED_MODEL::BipedObjectSlot;
-
-		if (!a_event || !a_event->hActor || !a_event->hActor->IsPlayerRef() || PlayerIsBeastRace()) {
-			return EventResult::kContinue;
-		}
-
-		auto armor = RE::TESForm::LookupByID<RE::TESObjectARMO>(a_event->baseObject);
-		if (!armor) {
-			return EventResult::kContinue;
-		}
-
-		if (armor->HasPartOf(FirstPersonFlag::kShield)) {
-			auto shield = Shield::GetSingleton();
-			if (a_event->equipped) {
-				shield->SetForm(a_event->baseObject);
-			} else {
-				auto player = RE::PlayerCharacter::GetSingleton();
-				if (player->IsWeaponDrawn()) {
-					shield->Clear();
-				}
-			}
-		}
-
-		return EventResult::kContinue;
+		return a_instance.formID == Shield::GetSingleton()->GetFormID();
 	}
 
 
-	BSAnimationGraphEventHandler* BSAnimationGraphEventHandler::GetSingleton()
+	bool ShieldPolicy::IsManagedArmor(RE::TESObjectARMO* a_armor)
 	{
-		static BSAnimationGraphEventHandler singleton;
-		return &singleton;
+		return a_armor->formID == Shield::GetSingleton()->GetFormID() && a_armor->HasPartOf(FirstPersonFlag::kShield);
 	}
 
 
-	auto BSAnimationGraphEventHandler::ProcessEvent(const RE::BSAnimationGraphEvent* a_event, RE::BSTEventSource<RE::BSAnimationGraphEvent>* a_eventSource)
-		-> EventResult
+	void ShieldPolicy::OnEquip(RE::TESObjectARMO* a_armor, bool a_equipped)
 	{
-		if (!a_event || !a_event->holder || !a_event->holder->IsPlayerRef()) {
-			return EventResult::kContinue;
-		}
-
-		auto task = SKSE::GetTaskInterface();
-		switch (HashAnimation(a_event->tag)) {
-		case Anim::kWeaponDraw:
-			if (!PlayerIsBeastRace()) {
-				task->AddTask(new ShieldTaskDelegate(true));
-			}
-			break;
-		case Anim::kWeaponSheathe:
-			if (!PlayerIsBeastRace()) {
-				task->AddTask(new ShieldTaskDelegate(false));
-			}
-			break;
-		case Anim::kTailCombatIdle:
-			if (!PlayerIsBeastRace()) {
-				g_skipAnim = false;
+		auto shield = Shield::GetSingleton();
+		if (a_equipped) {
+			shield->SetForm(a_armor->formID);
+		} else {
+			auto player = RE::PlayerCharacter::GetSingleton();
+			if (player->IsWeaponDrawn()) {
+				shield->Clear();
 			}
-			break;
-		case Anim::kGraphDeleting:
-			task->AddTask(new AnimGraphSinkDelegate());
-			break;
 		}
-
-		return EventResult::kContinue;
 	}
 
 
@@ -203,7 +117,7 @@ namespace Shield
 		{
 			REL::Offset<func_t**> vFunc(RE::Offset::PlayerCharacter::Vtbl + (0xB2 * 0x8));
 			func = *vFunc;
-			SafeWrite64(vFunc.GetAddress(), GetFnAddr(&Hook_OnItemEquipped));
+			SafeWrite64(vFunc.GetAddress(), GetFnAddr(&PlayerCharacterEx::Hook_OnItemEquipped));
 			_DMESSAGE("Installed hooks for (%s)", typeid(PlayerCharacterEx).name());
 		}
 	};
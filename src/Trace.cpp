@@ -0,0 +1,282 @@
+#include "Trace.h"
+
+#include "skse64/gamethreads.h"  // TaskDelegate
+
+#include <algorithm>  // max
+#include <atomic>  // atomic
+#include <chrono>  // duration_cast, steady_clock
+#include <cstdio>  // FILE, fopen, fread, fwrite, fflush, fclose
+#include <mutex>  // mutex, lock_guard
+#include <thread>  // thread, sleep_until
+#include <utility>  // move
+#include <vector>  // vector
+
+#include "Animations.h"  // Anim
+#include "Events.h"  // DispatchAnimation, DispatchEquip, DispatchPlayerLoaded
+#include "ISerializableForm.h"  // SlotRecord
+#include "PlayerInventory.h"  // PlayerInventory, AmmoCounts
+#include "PlayerUtil.h"  // UpdatePlayerBeastRace
+#include "Scheduler.h"  // AddTask, Priority
+#include "Serialization.h"  // Snapshot, Restore
+#include "TaskPool.h"  // TaskPool
+#include "WornSlots.h"  // WornSlots
+
+#include "RE/Skyrim.h"
+#include "SKSE/API.h"
+
+
+namespace Trace
+{
+	namespace
+	{
+		enum : UInt32
+		{
+			kMagic = 'DNMT',
+			kVersion = 2
+		};
+
+
+		enum : std::size_t { kBufferSize = 256 };
+
+
+		struct Header
+		{
+			UInt32 magic;
+			UInt32 version;
+		};
+
+
+		using Clock = std::chrono::steady_clock;
+
+
+		std::atomic<bool> g_recording = false;
+		std::mutex g_lock;
+		std::FILE* g_file = 0;
+		std::vector<Entry> g_buffer;
+		Clock::time_point g_start;
+		std::atomic<UInt64> g_maxLag = 0;
+		std::atomic<bool> g_replaying = false;
+		std::vector<SlotRecord> g_snapshot;
+
+
+		void WriteBuffer()
+		{
+			if (g_file && !g_buffer.empty()) {
+				std::fwrite(g_buffer.data(), sizeof(Entry), g_buffer.size(), g_file);
+			}
+			g_buffer.clear();
+		}
+
+
+		// Other actors' events were recorded to keep the trace's load, but the sinks drop them
+		void Dispatch(const Entry& a_entry)
+		{
+			if ((a_entry.flags & kPlayer) == 0) {
+				return;
+			}
+
+			switch (a_entry.kind) {
+			case Kind::kAnimation:
+				Events::DispatchAnimation(static_cast<Anim>(a_entry.payload));
+				break;
+			case Kind::kEquip:
+				Events::DispatchEquip(static_cast<RE::FormID>(a_entry.payload), (a_entry.flags & kEquipped) != 0);
+				break;
+			case Kind::kObjectLoaded:
+				Events::DispatchPlayerLoaded();
+				break;
+			case Kind::kSwitchRace:
+				UpdatePlayerBeastRace();
+				break;
+			}
+		}
+
+
+		// Queued behind the tasks the last replayed event started, so none of them runs against the restored state
+		// The replay equipped nothing, so the caches are rebuilt from what the player actually holds and wears
+		class ReplayFinishDelegate : public TaskDelegate
+		{
+		public:
+			virtual void Run() override
+			{
+				Serialization::Restore(g_snapshot);
+				g_snapshot.clear();
+				Inventory::PlayerInventory::GetSingleton()->Invalidate();
+				Inventory::AmmoCounts::GetSingleton()->Invalidate();
+				Inventory::WornSlots::GetSingleton()->Invalidate();
+				UpdatePlayerBeastRace();
+				g_replaying = false;
+
+				_MESSAGE("Finished replaying traced events, max dispatch lag (%llu) us", g_maxLag.load());
+			}
+
+
+			virtual void Dispose() override
+			{
+				TaskPool<ReplayFinishDelegate>::Release(this);
+			}
+		};
+
+
+		// Runs one replayed event on the game thread, where the sinks would have dispatched it
+		// The lag is measured here, so it includes the wait for the game to pick up the task
+		class ReplayTaskDelegate : public TaskDelegate
+		{
+		public:
+			ReplayTaskDelegate(const Entry& a_entry, Clock::time_point a_due, std::size_t a_remaining) :
+				_entry(a_entry),
+				_due(a_due),
+				_remaining(a_remaining)
+			{}
+
+
+			virtual void Run() override
+			{
+				auto lag = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - _due).count();
+				g_maxLag = std::max<UInt64>(g_maxLag, lag);
+				Dispatch(_entry);
+
+				if (_remaining == 0) {
+					Scheduler::AddTask(TaskPool<ReplayFinishDelegate>::Create(), Scheduler::Priority::kBookkeeping);
+				}
+			}
+
+
+			virtual void Dispose() override
+			{
+				TaskPool<ReplayTaskDelegate>::Release(this);
+			}
+
+		private:
+			Entry _entry;
+			Clock::time_point _due;
+			std::size_t _remaining;
+		};
+	}
+
+
+	bool StartRecording(const char* a_path)
+	{
+		std::lock_guard<std::mutex> locker(g_lock);
+		if (g_file) {
+			return false;
+		}
+
+		g_file = std::fopen(a_path, "wb");
+		if (!g_file) {
+			_ERROR("Failed to open event trace (%s)!\n", a_path);
+			return false;
+		}
+
+		Header header{ kMagic, kVersion };
+		std::fwrite(&header, sizeof(header), 1, g_file);
+		g_buffer.reserve(kBufferSize);
+		g_start = Clock::now();
+		g_recording = true;
+		return true;
+	}
+
+
+	void Flush()
+	{
+		std::lock_guard<std::mutex> locker(g_lock);
+		if (g_file) {
+			WriteBuffer();
+			std::fflush(g_file);
+		}
+	}
+
+
+	bool IsRecording()
+	{
+		return g_recording;
+	}
+
+
+	void Record(Kind a_kind, UInt64 a_payload, bool a_player, bool a_equipped)
+	{
+		if (!g_recording) {
+			return;
+		}
+
+		auto timestamp = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - g_start).count();
+
+		std::lock_guard<std::mutex> locker(g_lock);
+		if (!g_file) {
+			return;
+		}
+
+		UInt8 flags = kNone;
+		if (a_player) {
+			flags |= kPlayer;
+		}
+		if (a_equipped) {
+			flags |= kEquipped;
+		}
+		g_buffer.push_back({ static_cast<UInt64>(timestamp), a_payload, a_kind, flags, {} });
+		if (g_buffer.size() >= kBufferSize) {
+			WriteBuffer();
+		}
+	}
+
+
+	bool Replay(const char* a_path)
+	{
+		if (g_replaying) {
+			return false;
+		}
+
+		auto file = std::fopen(a_path, "rb");
+		if (!file) {
+			_ERROR("Failed to open event trace (%s)!\n", a_path);
+			return false;
+		}
+
+		Header header;
+		if (std::fread(&header, sizeof(header), 1, file) != 1 || header.magic != kMagic || header.version != kVersion) {
+			_ERROR("Event trace (%s) has an invalid header!\n", a_path);
+			std::fclose(file);
+			return false;
+		}
+
+		std::vector<Entry> entries;
+		Entry entry;
+		while (std::fread(&entry, sizeof(entry), 1, file) == 1) {
+			entries.push_back(entry);
+		}
+		std::fclose(file);
+
+		_MESSAGE("Replaying (%zu) traced events", entries.size());
+		if (entries.empty()) {
+			return true;
+		}
+
+		g_maxLag = 0;
+		Serialization::Snapshot(g_snapshot);
+		g_replaying = true;
+		std::thread([](std::vector<Entry> a_entries)
+		{
+			auto task = SKSE::GetTaskInterface();
+			auto start = Clock::now();
+			auto remaining = a_entries.size();
+			for (auto& entry : a_entries) {
+				auto due = start + std::chrono::microseconds(entry.timestamp);
+				std::this_thread::sleep_until(due);
+				task->AddTask(TaskPool<ReplayTaskDelegate>::Create(entry, due, --remaining));
+			}
+		}, std::move(entries)).detach();
+		return true;
+	}
+
+
+	bool IsReplaying()
+	{
+		return g_replaying;
+	}
+
+
+	std::size_t GetReplayOverflowCount()
+	{
+		return TaskPool<ReplayTaskDelegate>::GetOverflowCount() + TaskPool<ReplayFinishDelegate>::GetOverflowCount();
+	}
+}
@@ -0,0 +1,158 @@
+#include "WornSlots.h"
+
+#include <mutex>  // lock_guard
+
+#include "ISerializableForm.h"  // kInvalid
+#include "PlayerInventory.h"  // PlayerInventory
+
+#include "RE/Skyrim.h"
+
+
+namespace Inventory
+{
+	WornSlots* WornSlots::GetSingleton()
+	{
+		static WornSlots singleton;
+		return &singleton;
+	}
+
+
+	FormID WornSlots::GetItem(Slot a_slot)
+	{
+		Sync();
+		std::lock_guard<std::mutex> locker(_lock);
+		auto slot = static_cast<UInt32>(a_slot);
+		for (std::size_t i = 0; i < kNumSlots; ++i) {
+			if (slot & (1u << i)) {
+				return _items[i];
+			}
+		}
+		return kInvalid;
+	}
+
+
+	bool WornSlots::IsWorn(FormID a_formID)
+	{
+		Sync();
+		std::lock_guard<std::mutex> locker(_lock);
+		for (std::size_t i = 0; i < kNumSlots; ++i) {
+			if (_items[i] == a_formID) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+
+	// Read from the live inventory changes, since the engine swaps extra lists without notice
+	// Worn items always carry extra data, so only the changes entries need to be searched
+	RE::ExtraDataList* WornSlots::GetExtraList(FormID a_formID)
+	{
+		auto player = RE::PlayerCharacter::GetSingleton();
+		auto changes = player->GetInventoryChanges();
+		if (!changes || !changes->entryList) {
+			return 0;
+		}
+
+		for (auto& entry : *changes->entryList) {
+			if (entry && entry->object && entry->object->formID == a_formID && entry->extraLists) {
+				for (auto& xList : *entry->extraLists) {
+					if (xList && xList->HasType(RE::ExtraDataType::kWorn)) {
+						return xList;
+					}
+				}
+				return 0;
+			}
+		}
+		return 0;
+	}
+
+
+	void WornSlots::Update(RE::TESObjectARMO* a_armor, bool a_equipped)
+	{
+		std::lock_guard<std::mutex> locker(_lock);
+		if (_rebuild) {
+			return;
+		}
+
+		auto slots = static_cast<UInt32>(a_armor->GetSlotMask());
+		if (a_equipped) {
+			Set(_items, slots, a_armor->formID);
+		} else {
+			for (std::size_t i = 0; i < kNumSlots; ++i) {
+				if ((slots & (1u << i)) && _items[i] == a_armor->formID) {
+					_items[i] = kInvalid;
+				}
+			}
+		}
+	}
+
+
+	void WornSlots::Invalidate()
+	{
+		std::lock_guard<std::mutex> locker(_lock);
+		_rebuild = true;
+	}
+
+
+	WornSlots::Visitor::Visitor(Items& a_items) :
+		_items(a_items)
+	{}
+
+
+	bool WornSlots::Visitor::Accept(InventoryEntryView* a_entry, SInt32 a_count)
+	{
+		if (a_entry->object->Is(RE::FormType::Armor) && a_entry->extraLists) {
+			for (auto& xList : *a_entry->extraLists) {
+				if (xList->HasType(RE::ExtraDataType::kWorn)) {
+					auto armor = static_cast<RE::TESObjectARMO*>(a_entry->object);
+					Set(_items, static_cast<UInt32>(armor->GetSlotMask()), armor->formID);
+					break;
+				}
+			}
+		}
+		return true;
+	}
+
+
+	WornSlots::WornSlots() :
+		_lock(),
+		_items(),
+		_rebuild(true)
+	{
+		_items.fill(kInvalid);
+	}
+
+
+	void WornSlots::Sync()
+	{
+		{
+			std::lock_guard<std::mutex> locker(_lock);
+			if (!_rebuild) {
+				return;
+			}
+		}
+
+		// Scanned without the lock held, since the inventory visit takes its own
+		Items items;
+		items.fill(kInvalid);
+		Visitor visitor(items);
+		PlayerInventory::GetSingleton()->Visit(&visitor);
+
+		std::lock_guard<std::mutex> locker(_lock);
+		if (_rebuild) {
+			_items = items;
+			_rebuild = false;
+		}
+	}
+
+
+	void WornSlots::Set(Items& a_items, UInt32 a_slots, FormID a_formID)
+	{
+		for (std::size_t i = 0; i < kNumSlots; ++i) {
+			if (a_slots & (1u << i)) {
+				a_items[i] = a_formID;
+			}
+		}
+	}
+}
@@ -1,12 +1,22 @@
 ﻿#include "skse64_common/skse_version.h"  // RUNTIME_VERSION
 
-#include <string>  // string
-
-#include "Ammo.h"  // Ammo, TESEquipEventHandler
-#include "Helmet.h"  // Helmet, BSAnimationGraphEventHandler
-#include "PlayerUtil.h"  // SinkAnimationGraphEventHandler
+#include "Ammo.h"  // Ammo
+#include "Animations.h"  // ClearAnimationCache
+#include "Events.h"  // TESEquipEventHandler, TESObjectLoadedEventHandler, TESSwitchRaceCompleteEventHandler, AnimGraphSinkDelegate
+#include "Forms.h"  // InvalidateFormCache
+#include "Log.h"  // Open, SetPrintLevel, StartWriter, GetDroppedCount
+#include "ManagedSlots.h"  // ManagedSlots
+#include "MenuRefresh.h"  // MenuOpenCloseEventHandler, InventoryMenuRefreshDelegate
+#include "Metrics.h"  // Dump, StartPeriodicDump
+#include "PlayerInventory.h"  // PlayerInventory, AmmoCounts, TESContainerChangedEventHandler
+#include "PlayerUtil.h"  // UpdatePlayerBeastRace, GetInventoryTaskOverflowCount
+#include "Scheduler.h"  // InstallHooks, GetDeferredCount, GetPumpOverflowCount
+#include "Serialization.h"  // Save, Load
 #include "Settings.h"  // Settings
-#include "Shield.h"  // Shield, BSAnimationGraphEventHandler
+#include "Shield.h"  // InstallHooks
+#include "TaskPool.h"  // TaskPool
+#include "Trace.h"  // StartRecording, Flush, Replay, GetReplayOverflowCount
+#include "WornSlots.h"  // WornSlots
 #include "version.h"  // VERSION_VERSTRING, VERSION_MAJOR
 
 #include "SKSE/API.h"
@@ -17,47 +27,41 @@ namespace
 {
 	enum
 	{
-		kSerializationVersion = 3,
-		kDynamicEquipmentManager = 'DNEM',
-		kAmmo = 'AMMO',
-		kHelmet = 'HELM',
-		kShield = 'SHLD'
+		kDynamicEquipmentManager = 'DNEM'
 	};
 
 
-	std::string DecodeTypeCode(UInt32 a_typeCode)
-	{
-		constexpr std::size_t SIZE = sizeof(UInt32);
+	constexpr char TRACE_FILE_NAME[] = "Data\\SKSE\\Plugins\\DynamicEquipmentManagerSSE.trace";
 
-		std::string sig;
-		sig.resize(SIZE);
-		char* iter = reinterpret_cast<char*>(&a_typeCode);
-		for (std::size_t i = 0, j = SIZE - 2; i < SIZE - 1; ++i, --j) {
-			sig[j] = iter[i];
-		}
-		return sig;
+
+	void DumpMetrics()
+	{
+		Metrics::Dump();
+		_MESSAGE("Task pool overflows: inventory (%zu), helmet (%zu), shield (%zu), weapon (%zu), ammo (%zu), helmet locator (%zu), menu refresh (%zu), anim graph sink (%zu), scheduler pump (%zu), replay (%zu)",
+			GetInventoryTaskOverflowCount(),
+			TaskPool<Helmet::Manager::SlotTaskDelegate>::GetOverflowCount(),
+			TaskPool<Shield::Manager::SlotTaskDelegate>::GetOverflowCount(),
+			TaskPool<Ammo::DelayedWeaponTaskDelegate>::GetOverflowCount(),
+			TaskPool<Ammo::DelayedAmmoTaskDelegate>::GetOverflowCount(),
+			TaskPool<Helmet::DelayedHelmetLocator>::GetOverflowCount(),
+			TaskPool<Menu::InventoryMenuRefreshDelegate>::GetOverflowCount(),
+			TaskPool<Events::AnimGraphSinkDelegate>::GetOverflowCount(),
+			Scheduler::GetPumpOverflowCount(),
+			Trace::GetReplayOverflowCount());
+		_MESSAGE("Coalesced equip intents: helmet (%zu), shield (%zu)", Helmet::Manager::GetDroppedCount(), Shield::Manager::GetDroppedCount());
+		_MESSAGE("Frames with deferred bookkeeping tasks: (%zu)", Scheduler::GetDeferredCount());
+		_MESSAGE("Dropped log messages: (%zu)", Log::GetDroppedCount());
 	}
 
 
 	void SaveCallback(SKSE::SerializationInterface* a_intfc)
 	{
-		auto ammo = Ammo::Ammo::GetSingleton();
-		if (!ammo->Save(a_intfc, kAmmo, kSerializationVersion)) {
-			_ERROR("Failed to save ammo!\n");
-			ammo->Clear();
-		}
-
-		auto helmet = Helmet::Helmet::GetSingleton();
-		if (!helmet->Save(a_intfc, kHelmet, kSerializationVersion)) {
-			_ERROR("Failed to save helmet!\n");
-			helmet->Clear();
+		if (!Serialization::Save(a_intfc)) {
+			_ERROR("Failed to save data!\n");
 		}
 
-		auto shield = Shield::Shield::GetSingleton();
-		if (!shield->Save(a_intfc, kShield, kSerializationVersion)) {
-			_ERROR("Failed to save shield!\n");
-			shield->Clear();
-		}
+		Trace::Flush();
+		DumpMetrics();
 
 		_MESSAGE("Finished saving data");
 	}
@@ -65,120 +69,61 @@ namespace
 
 	void LoadCallback(SKSE::SerializationInterface* a_intfc)
 	{
-		auto ammo = Ammo::Ammo::GetSingleton();
-		ammo->Clear();
-		auto helmet = Helmet::Helmet::GetSingleton();
-		helmet->Clear();
-		auto shield = Shield::Shield::GetSingleton();
-		shield->Clear();
-
-		UInt32 type;
-		UInt32 version;
-		UInt32 length;
-		while (a_intfc->GetNextRecordInfo(type, version, length)) {
-			if (version != kSerializationVersion) {
-				_ERROR("Loaded data is out of date! Read (%u), expected (%u) for type code (%s)", version, kSerializationVersion, DecodeTypeCode(type).c_str());
-				continue;
-			}
+		Ammo::Ammo::GetSingleton()->Clear();
+		ManagedSlots::Clear();
+		Inventory::PlayerInventory::GetSingleton()->Invalidate();
+		Inventory::AmmoCounts::GetSingleton()->Invalidate();
+		Inventory::WornSlots::GetSingleton()->Invalidate();
+		ClearAnimationCache();
+		InvalidateFormCache();
+		UpdatePlayerBeastRace();
 
-			switch (type) {
-			case kAmmo:
-				if (!ammo->Load(a_intfc)) {
-					_ERROR("Failed to load ammo!\n");
-					ammo->Clear();
-				}
-				break;
-			case kHelmet:
-				if (!helmet->Load(a_intfc)) {
-					_ERROR("Failed to load helmet!\n");
-					helmet->Clear();
-				}
-				break;
-			case kShield:
-				if (!shield->Load(a_intfc)) {
-					_ERROR("Failed to load shield!\n");
-					shield->Clear();
-				}
-				break;
-			default:
-				_ERROR("Unrecognized record type (%s)!", DecodeTypeCode(type).c_str());
-				break;
-			}
-		}
+		Serialization::Load(a_intfc);
 
 		_MESSAGE("Finished loading data");
 	}
 
 
-	class TESObjectLoadedEventHandler : public RE::BSTEventSink<RE::TESObjectLoadedEvent>
-	{
-	public:
-		using EventResult = RE::BSEventNotifyControl;
-
-
-		static TESObjectLoadedEventHandler* GetSingleton()
-		{
-			static TESObjectLoadedEventHandler singleton;
-			return &singleton;
-		}
-
-
-		virtual EventResult ProcessEvent(const RE::TESObjectLoadedEvent* a_event, RE::BSTEventSource<RE::TESObjectLoadedEvent>* a_eventSource) override
-		{
-			if (!a_event) {
-				return EventResult::kContinue;
-			}
-
-			auto player = RE::PlayerCharacter::GetSingleton();
-			if (a_event->formID == player->formID) {
-				if (Settings::manageHelmet) {
-					if (SinkAnimationGraphEventHandler(Helmet::BSAnimationGraphEventHandler::GetSingleton())) {
-						_MESSAGE("Registered helmet player animation event handler");
-					}
-				}
-				if (Settings::manageShield) {
-					if (SinkAnimationGraphEventHandler(Shield::BSAnimationGraphEventHandler::GetSingleton())) {
-						_MESSAGE("Registered shield player animation event handler");
-					}
-				}
-			}
-
-			return EventResult::kContinue;
-		}
-
-	protected:
-		TESObjectLoadedEventHandler() = default;
-		TESObjectLoadedEventHandler(const TESObjectLoadedEventHandler&) = delete;
-		TESObjectLoadedEventHandler(TESObjectLoadedEventHandler&&) = delete;
-		virtual ~TESObjectLoadedEventHandler() = default;
-
-		TESObjectLoadedEventHandler& operator=(const TESObjectLoadedEventHandler&) = delete;
-		TESObjectLoadedEventHandler& operator=(TESObjectLoadedEventHandler&&) = delete;
-	};
-
-
 	void MessageHandler(SKSE::MessagingInterface::Message* a_msg)
 	{
 		switch (a_msg->type) {
 		case SKSE::MessagingInterface::kDataLoaded:
 			{
+				Metrics::StartPeriodicDump(DumpMetrics);
+
 				auto sourceHolder = RE::ScriptEventSourceHolder::GetSingleton();
-				sourceHolder->AddEventSink(TESObjectLoadedEventHandler::GetSingleton());
+				sourceHolder->AddEventSink(Events::TESObjectLoadedEventHandler::GetSingleton());
 				_MESSAGE("Registered object loaded event handler");
 
-				if (Settings::manageAmmo) {
-					sourceHolder->AddEventSink(Ammo::TESEquipEventHandler::GetSingleton());
-					_MESSAGE("Registered ammo equip event handler");
+				sourceHolder->AddEventSink(Inventory::TESContainerChangedEventHandler::GetSingleton());
+				_MESSAGE("Registered container changed event handler");
+
+				sourceHolder->AddEventSink(Events::TESSwitchRaceCompleteEventHandler::GetSingleton());
+				_MESSAGE("Registered switch race complete event handler");
+
+				if (Events::EquipEventsEnabled()) {
+					sourceHolder->AddEventSink(Events::TESEquipEventHandler::GetSingleton());
+					_MESSAGE("Registered equip event handler");
 				}
 
-				if (Settings::manageHelmet) {
-					sourceHolder->AddEventSink(Helmet::TESEquipEventHandler::GetSingleton());
-					_MESSAGE("Registered helmet equip event handler");
+				if (Settings::manageAmmo) {
+					auto ui = RE::UI::GetSingleton();
+					ui->GetEventSource<RE::MenuOpenCloseEvent>()->AddEventSink(Menu::MenuOpenCloseEventHandler::GetSingleton());
+					_MESSAGE("Registered menu open/close event handler");
 				}
 
-				if (Settings::manageShield) {
-					sourceHolder->AddEventSink(Shield::TESEquipEventHandler::GetSingleton());
-					_MESSAGE("Registered shield equip event handler");
+				if (Settings::recordEventTrace && !Settings::replayEventTrace) {
+					if (Trace::StartRecording(TRACE_FILE_NAME)) {
+						_MESSAGE("Recording event trace");
+					}
+				}
+			}
+			break;
+		case SKSE::MessagingInterface::kPostLoadGame:
+			if (Settings::replayEventTrace) {
+				static bool replayed = false;
+				if (!replayed) {
+					replayed = Trace::Replay(TRACE_FILE_NAME);
 				}
 			}
 			break;
@@ -190,10 +135,8 @@ namespace
 extern "C" {
 	bool SKSEPlugin_Query(const SKSE::QueryInterface* a_skse, SKSE::PluginInfo* a_info)
 	{
-		SKSE::Logger::OpenRelative(FOLDERID_Documents, L"\\My Games\\Skyrim Special Edition\\SKSE\\DynamicEquipmentManagerSSE.log");
-		SKSE::Logger::SetPrintLevel(SKSE::Logger::Level::kDebugMessage);
-		SKSE::Logger::SetFlushLevel(SKSE::Logger::Level::kDebugMessage);
-		SKSE::Logger::UseLogStamp(true);
+		Log::Open(FOLDERID_Documents, L"\\My Games\\Skyrim Special Edition\\SKSE\\DynamicEquipmentManagerSSE.log");
+		Log::SetPrintLevel(Log::Level::kDebugMessage);
 
 		_MESSAGE("DynamicEquipmentManagerSSE v%s", DNEM_VERSION_VERSTRING);
 
@@ -249,11 +192,16 @@ extern "C" {
 		serialization->SetSaveCallback(SaveCallback);
 		serialization->SetLoadCallback(LoadCallback);
 
+		Scheduler::InstallHooks();
+		_MESSAGE("Installed hooks for scheduler");
+
 		if (Settings::manageShield) {
 			Shield::InstallHooks();
 			_MESSAGE("Installed hooks for shield");
 		}
 
+		Log::StartWriter();
+
 		return true;
 	}
 };